@@ -0,0 +1,78 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// opt-in capture log, every transition of the instances that enable it and their frames, see tools/replay-capture.c
+
+#include "plugin-common.h"
+
+#include <util/threading.h>
+
+static FILE *capture_file = NULL;
+static bool capture_failed = false;
+static pthread_mutex_t capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// expects the mutex held, a failed open isn't retried until the next session
+static bool open_capture_log(void)
+{
+    if (capture_file) return true;
+    if (capture_failed) return false;
+
+    char *capture_path = obs_module_config_path(CAPTURE_FILE);
+    capture_file = capture_path ? os_fopen(capture_path, "ab") : NULL;
+
+    if (!capture_file) {
+        obs_log(LOG_WARNING, "couldn't open capture log '%s'", capture_path ? capture_path : CAPTURE_FILE);
+        capture_failed = true;
+        bfree(capture_path);
+        return false;
+    }
+
+    if (os_ftelli64(capture_file) == 0) {
+        struct meltscr_capture_header header = {CAPTURE_MAGIC, CAPTURE_VERSION};
+        fwrite(&header, sizeof(header), 1, capture_file);
+    }
+
+    obs_log(LOG_INFO, "capturing transitions to '%s'", capture_path);
+    bfree(capture_path);
+    return true;
+}
+
+void capture_transition(struct meltscr_capture_transition *record, const uint8_t *offsets)
+{
+    record->type = CAPTURE_RECORD_TRANSITION;
+
+    pthread_mutex_lock(&capture_mutex);
+
+    if (open_capture_log()) {
+        fwrite(record, sizeof(*record), 1, capture_file);
+        fwrite(offsets, 1, record->offsets_size, capture_file);
+
+        // the previous transition's frames are complete by now, a crash loses at most the current one
+        fflush(capture_file);
+    }
+
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+void capture_frame(struct meltscr_capture_frame *frame)
+{
+    frame->type = CAPTURE_RECORD_FRAME;
+
+    pthread_mutex_lock(&capture_mutex);
+    if (open_capture_log()) fwrite(frame, sizeof(*frame), 1, capture_file);
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+void close_capture_log(void)
+{
+    pthread_mutex_lock(&capture_mutex);
+
+    if (capture_file) {
+        fclose(capture_file);
+        capture_file = NULL;
+    }
+
+    pthread_mutex_unlock(&capture_mutex);
+}
@@ -0,0 +1,57 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// capture log layout, plain C with no libobs dependencies so tools/replay-capture.c can read it
+
+#pragma once
+
+#include <stdint.h>
+
+#define CAPTURE_FILE "MELTDEMO.LMP"
+#define CAPTURE_MAGIC 0x4D444D4Du // "MDMM"
+#define CAPTURE_VERSION 1u
+
+#define CAPTURE_RECORD_TRANSITION 1u
+#define CAPTURE_RECORD_FRAME 2u
+
+#pragma pack(push, 1)
+
+// written once, when the file is created, records get appended after it across sessions
+struct meltscr_capture_header {
+    uint32_t magic;
+    uint32_t version;
+};
+
+// resolved parameters of a transition, followed by its 'offsets_size' offsets as uploaded to the atlas
+struct meltscr_capture_transition {
+    uint8_t type;
+    uint8_t table_type; // 0 DooM, 1 fixed, 2 dynamic
+    uint8_t steps;
+    uint8_t motion;
+    uint16_t slices;
+    uint16_t offsets_size;
+    uint32_t instance;
+    float factor;
+    float increment;
+    float dir[2];
+    uint64_t uuid;
+    uint32_t position; // table position once this transition's pattern was taken
+    uint32_t start_ns;
+    uint64_t timestamp_ns;
+};
+
+struct meltscr_capture_frame {
+    uint8_t type;
+    uint8_t technique; // VARIANT_* flags, bits 3-4 unused, the governor's level in bits 5-6
+    uint16_t slices;
+    uint32_t instance;
+    float t;
+    uint32_t cx;
+    uint32_t cy;
+    uint32_t cpu_ns;
+    uint32_t gpu_us; // measurement that came back this frame, from an earlier one, 0 if none did
+};
+
+#pragma pack(pop)
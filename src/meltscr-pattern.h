@@ -0,0 +1,119 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// pattern generation core, plain C with no libobs dependencies so it can be built on its own
+
+#pragma once
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+static inline int imax(int a, int b)
+{
+    return a > b ? a : b;
+}
+
+static inline int get_next_power_two(int value) {
+    int v= 2;
+    while (v < value) v = v * 2;
+    return v;
+}
+
+static inline int get_next_power_two_sqrted(int value)
+{
+    return get_next_power_two((int)sqrt(value));
+}
+
+static inline int clamp(int v, int min, int max) {
+    return v > max ? max : v < min ? min : v;
+}
+
+static inline void meltscr_pattern_values(uint8_t *values, uint32_t size)
+{
+    for (uint32_t i = 0u; i < size; i++) values[i] = rand() & 0xFF;
+}
+
+// clamped random walk over the values starting at 'position', returns the position it ended at
+static inline uint32_t meltscr_pattern_offsets(uint8_t *offsets, uint16_t slices, const uint8_t *values, uint32_t size, uint32_t position, int steps, float increment, float factor)
+{
+    uint8_t maxstep = steps - 1;
+    uint8_t stepsize = (uint8_t)round(255.0 * factor / maxstep);
+
+    uint8_t inc_value = (uint8_t)imax(1, (int)round(steps * increment));
+    uint8_t inc_modulo = (uint8_t)imax(3, inc_value * 2 + 1);
+
+    uint32_t pos = position;
+
+    offsets[0] = (uint8_t)(values[pos] % steps);
+
+    int8_t prev;
+
+    for (uint16_t i = 1; i < slices; i++) {
+
+        prev = offsets[i - 1];
+
+        pos++;
+        if (pos == size) pos = 0u;
+
+        offsets[i] = (uint8_t)clamp(prev - ((values[pos] % inc_modulo) - inc_value), 0, maxstep);
+    }
+
+    for (int i = 0; i < slices; i++) offsets[i] *= stepsize;
+
+    return pos;
+}
+
+#define PATTERN_LANES 16
+
+// same walk as meltscr_pattern_offsets for PATTERN_LANES independent patterns at once, one per lane.
+// offsets are written slice-major (out[slice * PATTERN_LANES + lane]) so the walk itself runs across lanes
+// with no dependencies between them, positions are read and updated per lane.
+static inline void meltscr_pattern_offsets_batch(uint8_t *out, uint16_t slices, const uint8_t *values, uint32_t size, uint32_t *positions, int steps, float increment, float factor)
+{
+    uint8_t maxstep = steps - 1;
+    uint8_t stepsize = (uint8_t)round(255.0 * factor / maxstep);
+
+    uint8_t inc_value = (uint8_t)imax(1, (int)round(steps * increment));
+    uint8_t inc_modulo = (uint8_t)imax(3, inc_value * 2 + 1);
+
+    // the modulos only depend on the byte value, a lookup keeps them out of the lane loop
+    int16_t first[256], delta[256];
+    for (int v = 0; v < 256; v++) {
+        first[v] = (int16_t)(v % steps);
+        delta[v] = (int16_t)((v % inc_modulo) - inc_value);
+    }
+
+    int16_t prev[PATTERN_LANES], step[PATTERN_LANES];
+
+    for (int l = 0; l < PATTERN_LANES; l++) {
+        prev[l] = first[values[positions[l]]];
+        out[l] = (uint8_t)(prev[l] * stepsize);
+    }
+
+    for (uint16_t i = 1; i < slices; i++) {
+
+        for (int l = 0; l < PATTERN_LANES; l++) {
+            if (++positions[l] == size) positions[l] = 0u;
+            step[l] = delta[values[positions[l]]];
+        }
+
+        uint8_t *row = &out[i * PATTERN_LANES];
+
+        for (int l = 0; l < PATTERN_LANES; l++) {
+            int16_t v = (int16_t)(prev[l] - step[l]);
+            v = v < 0 ? 0 : v;
+            v = v > maxstep ? maxstep : v;
+            prev[l] = v;
+            row[l] = (uint8_t)(v * stepsize);
+        }
+    }
+}
+
+// copies one lane of a batch into a regular offsets buffer
+static inline void meltscr_pattern_lane(uint8_t *offsets, const uint8_t *batch, uint16_t slices, int lane)
+{
+    for (uint16_t i = 0; i < slices; i++) offsets[i] = batch[i * PATTERN_LANES + lane];
+}
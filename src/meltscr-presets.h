@@ -0,0 +1,28 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// fixed pattern data, plain C with no libobs dependencies so the preset baker can link it too
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+extern const uint8_t original_values[256];
+
+// every pattern a fixed set of parameters produces over a fixed set of values, one per table position they can start at.
+// generated at build time by tools/bake-presets.c
+struct meltscr_baked_preset {
+    uint16_t slices; // phases are one atlas row each, 'slices' bytes apart
+    uint8_t steps;
+    float increment;
+    float factor;
+    uint16_t values_size; // also the number of phases
+    const uint8_t *values;
+    const uint8_t *phases;
+};
+
+extern const struct meltscr_baked_preset baked_presets[];
+extern const size_t baked_preset_count;
@@ -0,0 +1,204 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// optional host-wide library of tables, a compacted tables journal every OBS process maps read-only
+
+#include "plugin-common.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SHARED_TABLES_ENV "MELTSCR_SHARED_TABLES"
+
+struct meltscr_table **shared_tables = NULL;
+uint32_t shared_table_count = 0u;
+
+static const uint8_t *shared_data = NULL;
+static size_t shared_size = 0u;
+
+#ifdef _WIN32
+static HANDLE shared_file = INVALID_HANDLE_VALUE;
+static HANDLE shared_mapping = NULL;
+#endif
+
+static bool map_shared_file(const char *path)
+{
+#ifdef _WIN32
+    wchar_t *wpath = NULL;
+    os_utf8_to_wcs_ptr(path, 0, &wpath);
+
+    shared_file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    bfree(wpath);
+
+    if (shared_file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(shared_file, &size) || size.QuadPart == 0) return false;
+
+    shared_mapping = CreateFileMappingW(shared_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!shared_mapping) return false;
+
+    shared_data = MapViewOfFile(shared_mapping, FILE_MAP_READ, 0, 0, 0);
+    shared_size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) return false;
+
+    shared_data = data;
+    shared_size = (size_t)st.st_size;
+#endif
+    return shared_data != NULL;
+}
+
+static void unmap_shared_file(void)
+{
+#ifdef _WIN32
+    if (shared_data) UnmapViewOfFile(shared_data);
+    if (shared_mapping) CloseHandle(shared_mapping);
+    if (shared_file != INVALID_HANDLE_VALUE) CloseHandle(shared_file);
+
+    shared_mapping = NULL;
+    shared_file = INVALID_HANDLE_VALUE;
+#else
+    if (shared_data) munmap((void *)shared_data, shared_size);
+#endif
+    shared_data = NULL;
+    shared_size = 0u;
+}
+
+static void add_shared_table(struct meltscr_journal_record *record, const uint8_t *data)
+{
+    struct meltscr_table *table = NULL;
+
+    for (uint32_t i = 0u; i < shared_table_count && !table; i++) {
+        if (shared_tables[i]->uuid == record->uuid) table = shared_tables[i];
+    }
+
+    if (!table) {
+        table = bzalloc(sizeof(struct meltscr_table));
+        table->uuid = record->uuid;
+        table->_atlas_row = -1;
+
+        shared_tables = brealloc(shared_tables, sizeof(struct meltscr_table *) * (shared_table_count + 1u));
+        shared_tables[shared_table_count++] = table;
+    }
+
+    // the values are never written through this pointer, see make_table_private
+    table->_values = (uint8_t *)data;
+    table->values_capacity = 0u;
+    table->position = record->position;
+    table->values_size = record->values_size;
+    table->values_generated = record->values_size;
+    table->offsets_size = record->offsets_size;
+    table->state_flags = STATE_FLAG_SHARED | STATE_FLAG_DIRT;
+}
+
+void load_shared_tables(void)
+{
+    const char *path = getenv(SHARED_TABLES_ENV);
+
+    if (!path || !*path) return;
+
+    if (!map_shared_file(path)) {
+        obs_log(LOG_WARNING, "Unable to map the shared tables library at '%s'", path);
+        unmap_shared_file();
+        return;
+    }
+
+    size_t offset = TABLESFILE_HEADER_SIZE + 4u;
+    uint32_t magic = 0u;
+
+    if (shared_size >= offset) memcpy(&magic, &shared_data[TABLESFILE_HEADER_SIZE], 4);
+
+    if (magic != JOURNAL_MAGIC) {
+        obs_log(LOG_WARNING, "The shared tables library at '%s' isn't a tables journal", path);
+        unmap_shared_file();
+        return;
+    }
+
+    struct meltscr_journal_record record;
+
+    // buffer records only need remembering where they are, tables referring to them point right into the mapping
+    const struct meltscr_journal_record **buffer_records = NULL;
+    uint32_t buffer_record_count = 0u;
+
+    while (offset + sizeof(record) <= shared_size) {
+
+        memcpy(&record, &shared_data[offset], sizeof(record));
+
+        const uint8_t *data = &shared_data[offset + sizeof(record)];
+        const uint8_t *values = data;
+
+        bool valid = journal_record_valid(&record) && offset + sizeof(record) + record.data_size <= shared_size &&
+                     get_journal_checksum(&record, data) == record.checksum;
+
+        if (valid && record.type == JOURNAL_RECORD_TABLE_REF) {
+            uint64_t hash;
+            memcpy(&hash, data, sizeof(hash));
+
+            values = NULL;
+            for (uint32_t i = 0u; i < buffer_record_count && !values; i++) {
+                struct meltscr_journal_record buffer;
+                memcpy(&buffer, buffer_records[i], sizeof(buffer));
+
+                if (buffer.uuid == hash && buffer.data_size == record.values_size) values = (const uint8_t *)buffer_records[i] + sizeof(buffer);
+            }
+
+            valid = values != NULL;
+        }
+
+        if (!valid) {
+            obs_log(LOG_WARNING, "The shared tables library has a damaged record at offset %zu, ignoring the rest of it", offset);
+            break;
+        }
+
+        if (record.type == JOURNAL_RECORD_BUFFER) {
+            buffer_records = brealloc(buffer_records, sizeof(*buffer_records) * (buffer_record_count + 1u));
+            buffer_records[buffer_record_count++] = (const struct meltscr_journal_record *)&shared_data[offset];
+        }
+        else add_shared_table(&record, values);
+
+        offset += sizeof(record) + record.data_size;
+    }
+
+    bfree(buffer_records);
+
+    obs_log(LOG_INFO, "Mapped %u shared table(s) from '%s'", shared_table_count, path);
+}
+
+void unload_shared_tables(void)
+{
+    for (uint32_t i = 0u; i < shared_table_count; i++) {
+
+        struct meltscr_table *table = shared_tables[i];
+
+        release_table_values(table);
+        bfree(table);
+    }
+
+    bfree(shared_tables);
+
+    shared_tables = NULL;
+    shared_table_count = 0u;
+
+    unmap_shared_file();
+}
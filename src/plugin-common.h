@@ -4,6 +4,10 @@
 #include <plugin-support.h>
 #include <util/platform.h>
 
+#include "meltscr-pattern.h"
+#include "meltscr-presets.h"
+#include "meltscr-capture.h"
+
 #include <stdio.h>
 #include <time.h>
 
@@ -11,8 +15,35 @@
 
 #define TABLESFILE_HEADER_SIZE 48
 
+#define JOURNAL_FILE "TABLES2.WAD"
+#define JOURNAL_MAGIC 0x324C544Du // "MTL2"
+#define JOURNAL_RECORD_TABLE 1u
+#define JOURNAL_RECORD_BUFFER 2u // 'uuid' holds the content hash of the values that follow
+#define JOURNAL_RECORD_TABLE_REF 3u // table whose values are the buffer with the hash that follows
+#define JOURNAL_COMPACT_RECORDS 256u
+
 #define STATE_FLAG_DEAD 0b00000010
 #define STATE_FLAG_DIRT 0b00000001
+#define STATE_FLAG_SHARED 0b00000100 // values live in the read-only shared library
+#define STATE_FLAG_INTERNED 0b00001000 // values live in a deduplicated buffer, see intern_table_values
+
+#define HISTOGRAM_BUCKETS 32
+#define RENDER_CLASSES 4
+
+#define POOL_CHUNK_SIZE 65536u
+
+#define ATLAS_WIDTH 2048u // one row holds a whole pattern, has to fit max_slices
+#define ATLAS_MIN_ROWS 32u
+#define ATLAS_MAX_ROWS 1024u
+#define ATLAS_STAGING_ROWS 8u // rows uploaded at a time, then copied into the atlas on the GPU
+
+// log2 buckets of microseconds, bucket i holds samples in [2^i, 2^(i+1))
+struct meltscr_histogram {
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
 
 extern const uint32_t 
                 min_slices,
@@ -20,13 +51,55 @@ extern const uint32_t
                 min_steps,
                 max_steps,
                 max_length,
-                max_size;
-
-extern uint8_t original_values[256];
+                max_size,
+                max_pool_size;
 
 extern struct meltscr_table **tables;
 extern uint16_t table_count;
 
+// values several tables have the same content of, kept once and shared by content hash
+struct meltscr_buffer {
+    uint64_t hash;
+    uint32_t refs;
+    uint32_t size;
+    bool journaled; // the current journal file already holds it
+    uint8_t *data;
+};
+
+extern struct meltscr_buffer **buffers;
+extern uint32_t buffer_count;
+
+extern uint32_t journal_records;
+
+extern struct meltscr_table **shared_tables;
+extern uint32_t shared_table_count;
+
+extern void load_shared_tables(void);
+extern void unload_shared_tables(void);
+
+extern void capture_transition(struct meltscr_capture_transition *record, const uint8_t *offsets);
+extern void capture_frame(struct meltscr_capture_frame *frame);
+extern void close_capture_log(void);
+
+// offset patterns of every table share a single texture, one row each
+struct meltscr_atlas {
+    gs_texture_t *texture;
+    gs_texture_t *staging;
+    uint8_t *shadow;
+    struct meltscr_table **owners;
+    uint32_t rows;
+    uint32_t texture_rows;
+    uint32_t dirty_begin, dirty_end; // rows written since the last upload, none when they're equal
+};
+
+extern struct meltscr_atlas atlas;
+
+extern struct meltscr_histogram start_latency;
+extern struct meltscr_histogram render_time;
+extern struct meltscr_histogram gpu_time[RENDER_CLASSES];
+
+extern void report_stats(void);
+
 #pragma pack(push, 1)
 struct meltscr_table_packed {
     uint64_t uuid;
@@ -35,69 +108,104 @@ struct meltscr_table_packed {
     uint16_t values_size;
     uint16_t offsets_size;
 };
+
+struct meltscr_journal_record {
+    uint32_t checksum; // of everything after it, values included
+    uint8_t type;
+    uint64_t uuid;
+    uint32_t position;
+    uint32_t values_size;
+    uint16_t offsets_size;
+    uint8_t death_mark;
+    uint32_t data_size;
+};
 #pragma pack(pop)
 
 struct meltscr_table {
     uint64_t uuid;
-    uint16_t position;
+    uint32_t position;
     uint8_t users;
     uint8_t state_flags;
-    uint16_t values_size;
+    uint32_t values_size;
+    uint32_t values_capacity;
+    uint32_t values_generated;
     uint16_t offsets_size;
-    uint8_t 
-      *_values,
-      *_offsets;
-    gs_texture_t *_texture;
+    uint8_t *_values;
+    struct meltscr_buffer *_values_buffer;
+    int32_t _atlas_row;
 };
 
-static inline float lerp(float a, float b, float factor)
+static inline void histogram_record(struct meltscr_histogram *h, uint64_t ns)
 {
-    return (1 - factor) * a + factor * b;
+    uint64_t us = ns / 1000u;
+    int bucket = 0;
+    while (us > 1u && bucket < HISTOGRAM_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+
+    h->buckets[bucket]++;
+    h->count++;
+    h->total_ns += ns;
+    if (ns > h->max_ns) h->max_ns = ns;
 }
 
-static inline int imax(int a, int b)
+// upper bound of the bucket holding the given percentile, in microseconds. Never past the slowest sample,
+// the top bucket's bound can be nearly twice that
+static inline uint64_t histogram_percentile(const struct meltscr_histogram *h, double percentile)
 {
-    return a > b ? a : b;
-}
+    uint64_t target = (uint64_t)ceil(h->count * percentile), seen = 0u;
+    const uint64_t max_us = h->max_ns / 1000u + 1u;
 
-static inline int get_next_power_two(int value) {
-    int v= 2;
-    while (v < value) v = v * 2;
-    return v;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target && seen > 0u) return ((uint64_t)2u << i) < max_us ? (uint64_t)2u << i : max_us;
+    }
+    return 0u;
 }
 
-static inline int get_next_power_two_sqrted(int value)
+static void histogram_report(const struct meltscr_histogram *h, const char *name)
 {
-    return get_next_power_two((int)sqrt(value));
+    if (!h->count) return;
+
+    blog(LOG_INFO, "%s: %" PRIu64 " samples, avg %.1fus, p50 <%" PRIu64 "us, p99 <%" PRIu64 "us, max %.1fus", name, h->count,
+         h->total_ns / 1000.0 / h->count, histogram_percentile(h, .5), histogram_percentile(h, .99), h->max_ns / 1000.0);
+
+    char line[64];
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (!h->buckets[i]) continue;
+        snprintf(line, sizeof(line), "  <%" PRIu64 "us", (uint64_t)2u << i);
+        blog(LOG_INFO, "%-12s %" PRIu64, line, h->buckets[i]);
+    }
 }
 
-static inline int clamp(int v, int min, int max) {
-    return v > max ? max : v < min ? min : v;
+// 720p, 1080p, 1440p and anything over, by output height
+static inline int get_render_class(uint32_t cy)
+{
+    return cy <= 720u ? 0 : cy <= 1080u ? 1 : cy <= 1440u ? 2 : 3;
 }
 
-static void get_writable_table(struct meltscr_table_packed *out, struct meltscr_table *in)
+static inline float lerp(float a, float b, float factor)
 {
-    out->uuid = in->uuid;
-    out->position = in->position;
-    out->death_mark = in->users == 0u ? STATE_FLAG_DEAD : 0u;
-    out->values_size = in->values_size;
-    out->offsets_size = in->offsets_size;
+    return (1 - factor) * a + factor * b;
 }
 
-static void get_runtime_table(struct meltscr_table *out, struct meltscr_table_packed *in, uint8_t *values, uint8_t *offsets)
+static void get_runtime_table(struct meltscr_table *out, struct meltscr_table_packed *in, uint8_t *values)
 {
     out->uuid = in->uuid;
     out->position = in->position;
     out->users = 0u;
     out->state_flags = (in->death_mark ? STATE_FLAG_DEAD : 0u) | STATE_FLAG_DIRT;
     out->values_size = in->values_size;
+    out->values_capacity = max_size;
+    out->values_generated = in->values_size;
     out->offsets_size = in->offsets_size;
     out->_values = values;
-    out->_offsets = offsets;
-    out->_texture = NULL;
+    out->_values_buffer = NULL;
+    out->_atlas_row = -1;
 }
 
-static struct meltscr_table *get_table_by_uuid(uint64_t uuid)
+static struct meltscr_table *get_private_table_by_uuid(uint64_t uuid)
 {
     //blog(LOG_INFO, "searching for table with uuid %" PRIu64 " among %u tables", uuid, table_count);
     if (uuid) {
@@ -118,17 +226,105 @@ static struct meltscr_table *get_table_by_uuid(uint64_t uuid)
     return NULL;
 }
 
-static uint64_t create_table()
+// the shared library is authoritative for every uuid it holds, private tables come after it
+static struct meltscr_table *get_table_by_uuid(uint64_t uuid)
 {
-    struct meltscr_table *table = (struct meltscr_table *)bzalloc(sizeof(struct meltscr_table));
-    uint64_t uuid = (uint64_t)time(NULL);
+    if (uuid) {
+        for (uint32_t i = 0u; i < shared_table_count; i++) {
+            if (shared_tables[i]->uuid == uuid) return shared_tables[i];
+        }
+    }
+    return get_private_table_by_uuid(uuid);
+}
 
-    table->uuid = uuid;
-    table->users = 0u;
-    table->_values = bmalloc(max_size);
-    table->_offsets = bmalloc(max_size);
-    table->state_flags = STATE_FLAG_DIRT | STATE_FLAG_DEAD;
+static bool is_shared_table(const struct meltscr_table *table)
+{
+    for (uint32_t i = 0u; i < shared_table_count; i++) {
+        if (shared_tables[i] == table) return true;
+    }
+    return false;
+}
+
+// FNV-1a, 64 bits so buffers can be told apart by it
+static uint64_t buffer_hash(const uint8_t *data, uint32_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t i = 0u; i < size; i++) hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+static struct meltscr_buffer *get_buffer_by_hash(uint64_t hash)
+{
+    for (uint32_t i = 0u; i < buffer_count; i++) {
+        if (buffers[i]->hash == hash) return buffers[i];
+    }
+    return NULL;
+}
+
+// returns the buffer holding 'data', adding it if there's none yet. NULL if a different content already
+// has its hash, that content keeps it so a hash always names a single buffer, in memory and on disk
+static struct meltscr_buffer *intern_buffer(const uint8_t *data, uint32_t size)
+{
+    const uint64_t hash = buffer_hash(data, size);
+    struct meltscr_buffer *buffer = get_buffer_by_hash(hash);
+
+    if (buffer) return buffer->size == size && memcmp(buffer->data, data, size) == 0 ? buffer : NULL;
+
+    buffer = bzalloc(sizeof(struct meltscr_buffer));
+    buffer->hash = hash;
+    buffer->size = size;
+    buffer->data = bmalloc(size);
+    memcpy(buffer->data, data, size);
+
+    buffers = brealloc(buffers, sizeof(struct meltscr_buffer *) * (buffer_count + 1u));
+    buffers[buffer_count++] = buffer;
+
+    return buffer;
+}
+
+static void release_buffer(struct meltscr_buffer *buffer)
+{
+    if (buffer->refs > 0u && --buffer->refs > 0u) return;
+
+    for (uint32_t i = 0u; i < buffer_count; i++) {
+        if (buffers[i] == buffer) {
+            buffers[i] = buffers[--buffer_count];
+            break;
+        }
+    }
+
+    bfree(buffer->data);
+    bfree(buffer);
+}
+
+// drops whatever the table's values are, shared library values aren't ours to free
+static void release_table_values(struct meltscr_table *table)
+{
+    if (table->state_flags & STATE_FLAG_INTERNED) release_buffer(table->_values_buffer);
+    else if ((table->state_flags & STATE_FLAG_SHARED) == 0 && table->_values) bfree(table->_values);
+
+    table->_values = NULL;
+    table->_values_buffer = NULL;
+    table->values_capacity = 0u;
+    table->state_flags &= ~(STATE_FLAG_SHARED | STATE_FLAG_INTERNED);
+}
+
+// copy-on-write for shared and deduplicated values, neither can be modified in place
+static void make_table_private(struct meltscr_table *table)
+{
+    if ((table->state_flags & (STATE_FLAG_SHARED | STATE_FLAG_INTERNED)) == 0) return;
+
+    uint8_t *values = bmalloc(max_size);
+    memcpy(values, table->_values, table->values_size);
 
+    release_table_values(table);
+
+    table->_values = values;
+    table->values_capacity = max_size;
+}
+
+static void add_table(struct meltscr_table *table)
+{
     struct meltscr_table **newtables = bzalloc(sizeof(struct meltscr_table *) * (table_count + 1));
 
     if (table_count > 0u) {
@@ -140,6 +336,30 @@ static uint64_t create_table()
 
     tables = newtables;
     table_count++;
+}
+
+// seconds since the epoch, moved past any table already holding them: instances created within the same second,
+// or a scene collection loaded twice in one, would end up sharing a table otherwise
+static uint64_t new_table_uuid()
+{
+    uint64_t uuid = (uint64_t)time(NULL);
+    while (get_table_by_uuid(uuid)) uuid++;
+    return uuid;
+}
+
+static uint64_t create_table()
+{
+    struct meltscr_table *table = (struct meltscr_table *)bzalloc(sizeof(struct meltscr_table));
+    uint64_t uuid = new_table_uuid();
+
+    table->uuid = uuid;
+    table->users = 0u;
+    table->_values = bmalloc(max_size);
+    table->values_capacity = max_size;
+    table->_atlas_row = -1;
+    table->state_flags = STATE_FLAG_DIRT | STATE_FLAG_DEAD;
+
+    add_table(table);
 
     //blog(LOG_INFO, "allocated new table with uuid %llu for index %u at &[0x%llx]", uuid, table_count - 1, table);
     //obs_log(LOG_INFO, "total tables count: %u", table_count);
@@ -147,9 +367,131 @@ static uint64_t create_table()
     return uuid;
 }
 
+// every change to the rows needs the graphics context, the render thread reads them
+static void atlas_release_row(struct meltscr_table *table)
+{
+    if (table->_atlas_row < 0) return;
+
+    atlas.owners[table->_atlas_row] = NULL;
+    table->_atlas_row = -1;
+}
+
+static bool atlas_grow()
+{
+    uint32_t rows = atlas.rows ? atlas.rows * 2u : ATLAS_MIN_ROWS;
+    if (rows > ATLAS_MAX_ROWS) return false;
+
+    atlas.shadow = brealloc(atlas.shadow, (size_t)ATLAS_WIDTH * rows);
+    atlas.owners = brealloc(atlas.owners, sizeof(struct meltscr_table *) * rows);
+
+    memset(&atlas.shadow[(size_t)ATLAS_WIDTH * atlas.rows], 0, (size_t)ATLAS_WIDTH * (rows - atlas.rows));
+    memset(&atlas.owners[atlas.rows], 0, sizeof(struct meltscr_table *) * (rows - atlas.rows));
+
+    atlas.rows = rows;
+
+    return true;
+}
+
+// gives the table a row of its own, growing the atlas or taking one from a table nobody uses when full
+static bool atlas_acquire_row(struct meltscr_table *table)
+{
+    if (table->_atlas_row >= 0) return true;
+
+    int32_t row = -1;
+
+    for (uint32_t i = 0u; i < atlas.rows && row < 0; i++) {
+        if (!atlas.owners[i]) row = (int32_t)i;
+    }
+
+    if (row < 0) {
+        uint32_t rows = atlas.rows;
+        if (atlas_grow()) row = (int32_t)rows;
+    }
+
+    for (uint32_t i = 0u; i < atlas.rows && row < 0; i++) {
+        if (atlas.owners[i]->users == 0u) {
+            atlas_release_row(atlas.owners[i]);
+            row = (int32_t)i;
+        }
+    }
+
+    if (row < 0) {
+        obs_log(LOG_WARNING, "offsets atlas is full, table with uuid %" PRIu64 " can't be uploaded", table->uuid);
+        return false;
+    }
+
+    atlas.owners[row] = table;
+    table->_atlas_row = row;
+
+    return true;
+}
+
+// stages a pattern into the table's row, the texture is updated once before the next draw
+static bool atlas_write_row(struct meltscr_table *table, const uint8_t *offsets, uint16_t slices)
+{
+    if (!atlas_acquire_row(table)) return false;
+
+    const uint32_t row = (uint32_t)table->_atlas_row;
+
+    memcpy(&atlas.shadow[(size_t)ATLAS_WIDTH * row], offsets, slices);
+
+    if (atlas.dirty_begin == atlas.dirty_end) {
+        atlas.dirty_begin = row;
+        atlas.dirty_end = row + 1u;
+    }
+    else {
+        if (row < atlas.dirty_begin) atlas.dirty_begin = row;
+        if (row >= atlas.dirty_end) atlas.dirty_end = row + 1u;
+    }
+
+    return true;
+}
+
+// needs the graphics context
+static void atlas_upload()
+{
+    if (atlas.texture_rows == atlas.rows && atlas.dirty_begin == atlas.dirty_end) return;
+
+    // a grown atlas is created again from the whole shadow copy, that's the only full upload
+    if (!atlas.texture || atlas.texture_rows != atlas.rows) {
+        if (atlas.texture) gs_texture_destroy(atlas.texture);
+
+        // not dynamic, the GPU copies rows into it
+        const uint8_t *data[] = { atlas.shadow };
+        atlas.texture = gs_texture_create(ATLAS_WIDTH, atlas.rows, GS_R8, 1, data, 0);
+        atlas.texture_rows = atlas.rows;
+    }
+    else {
+        if (!atlas.staging) atlas.staging = gs_texture_create(ATLAS_WIDTH, ATLAS_STAGING_ROWS, GS_R8, 1, NULL, GS_DYNAMIC);
+        if (!atlas.staging) return;
+
+        // libobs can't update part of a texture, the rows written since the last upload go through the staging texture
+        // a few at a time. A chunk reaching past the last row starts earlier instead, those rows are unchanged anyway
+        for (uint32_t row = atlas.dirty_begin; row < atlas.dirty_end; row += ATLAS_STAGING_ROWS) {
+
+            const uint32_t first = row + ATLAS_STAGING_ROWS > atlas.rows ? atlas.rows - ATLAS_STAGING_ROWS : row;
+            const uint32_t count = atlas.dirty_end - row < ATLAS_STAGING_ROWS ? atlas.dirty_end - row : ATLAS_STAGING_ROWS;
+
+            gs_texture_set_image(atlas.staging, &atlas.shadow[(size_t)ATLAS_WIDTH * first], ATLAS_WIDTH, false);
+            gs_copy_texture_region(atlas.texture, 0, row, atlas.staging, 0, row - first, ATLAS_WIDTH, count);
+        }
+    }
+
+    atlas.dirty_begin = atlas.dirty_end = 0u;
+}
+
 static void leave_table(struct meltscr_table *table)
 {
-    if (table->users > 0u) table->users--;
+    if (table->users > 0u) {
+        table->users--;
+
+        // the free rows are looked up by whoever writes a row next, which happens inside the graphics context
+        if (table->users == 0u) {
+            obs_enter_graphics();
+            atlas_release_row(table);
+            obs_leave_graphics();
+        }
+    }
     else obs_log(LOG_WARNING, "table with uuid %" PRIu64 " x[0x%" PRIxPTR "] already had 0 users", table->uuid, table);
 }
 
@@ -161,10 +503,8 @@ static void join_table(struct meltscr_table *table)
 
 static void generate_table_values(struct meltscr_table *table)
 {
-    uint8_t *values = table->_values;
-    uint16_t size = table->values_size;
-
-    for (uint16_t i = 0u; i < size; i++) values[i] = rand() & 0xFF;
+    meltscr_pattern_values(table->_values, table->values_size);
+    table->values_generated = table->values_size;
 
     // DEBUG ONLY
 
@@ -189,38 +529,80 @@ static void generate_table_values(struct meltscr_table *table)
     //bfree(text);
 }
 
-static void generate_table_offsets(struct meltscr_table *table, int steps, float increment, float factor)
+// every write to the values goes through here first
+static void resize_table_values(struct meltscr_table *table, uint32_t capacity)
 {
-    uint8_t *values = table->_values;
-    uint8_t *offsets = table->_offsets;
-    uint16_t size = table->values_size;
-    uint16_t slices = table->offsets_size;
+    make_table_private(table);
 
-    uint8_t maxstep = steps - 1;
-    uint8_t stepsize = (uint8_t)round(255.0 * factor / maxstep);
+    if (table->values_capacity == capacity) return;
 
-    uint8_t inc_value = (uint8_t)imax(1, (int)round(steps * increment));
-    uint8_t inc_modulo = (uint8_t)imax(3, inc_value * 2 + 1);
+    table->_values = brealloc(table->_values, capacity);
+    table->values_capacity = capacity;
+}
 
-    uint16_t pos = table->position;
+// preset values are the only ones other tables can share, random ones would get a buffer all to themselves
+static inline bool is_preset_values(const uint8_t *data, uint32_t size)
+{
+    return size > 0u && size <= sizeof(original_values) && memcmp(data, original_values, size) == 0;
+}
 
-    offsets[0] = (uint8_t)(values[pos] % steps);
+// points the table to the one copy of 'data' every table with the same values uses
+static void intern_table_values(struct meltscr_table *table, const uint8_t *data, uint32_t size)
+{
+    struct meltscr_buffer *buffer = intern_buffer(data, size);
 
-    int8_t prev;
-    
-    for (uint16_t i = 1; i < slices; i++) {
+    // a hash collision, rare enough for the table to just keep a copy of its own
+    if (!buffer) {
+        if (table->_values != data) {
+            resize_table_values(table, max_size);
+            memcpy(table->_values, data, size);
+        }
+        return;
+    }
 
-        prev = offsets[i - 1];
+    // referenced before releasing, 'data' may be the table's own values or the buffer it already uses
+    buffer->refs++;
+    release_table_values(table);
 
-        pos++;
-        if (pos == size) pos = 0u;
+    table->_values = buffer->data;
+    table->_values_buffer = buffer;
+    table->state_flags |= STATE_FLAG_INTERNED;
+}
 
-        offsets[i] = (uint8_t)clamp(prev - ((values[pos] % inc_modulo) - inc_value), 0, maxstep);
-    }
+// turns the table into an empty value pool, values are generated as transitions reach them.
+// its memory starts at a single chunk and grows along with them, see stream_table_pool
+static void reset_table_pool(struct meltscr_table *table)
+{
+    resize_table_values(table, POOL_CHUNK_SIZE);
 
-    table->position = pos;
+    table->values_size = max_pool_size;
+    table->values_generated = 0u;
+    table->position = 0u;
+}
+
+// makes sure the values the next 'count' offsets will read from are generated, one chunk at a time
+static void stream_table_pool(struct meltscr_table *table, uint32_t count)
+{
+    uint32_t end = table->position + count;
+
+    // wrapping reads from the start of the pool, which has been generated on the first lap
+    if (end > table->values_size) end = table->values_size;
+
+    while (table->values_generated < end) {
+        uint32_t chunk = table->values_size - table->values_generated;
+        if (chunk > POOL_CHUNK_SIZE) chunk = POOL_CHUNK_SIZE;
 
-    for (int i = 0; i < slices; i++) offsets[i] *= stepsize;
+        if (table->values_capacity < table->values_generated + chunk) resize_table_values(table, table->values_generated + chunk);
+
+        meltscr_pattern_values(&table->_values[table->values_generated], chunk);
+        table->values_generated += chunk;
+    }
+}
+
+// 'offsets' needs room for the table's 'offsets_size', they only live until they're written to the atlas
+static void generate_table_offsets(struct meltscr_table *table, uint8_t *offsets, int steps, float increment, float factor)
+{
+    table->position = meltscr_pattern_offsets(offsets, table->offsets_size, table->_values, table->values_size, table->position, steps, increment, factor);
 
     // DEBUG ONLY
 
@@ -245,49 +627,204 @@ static void generate_table_offsets(struct meltscr_table *table, int steps, float
     //bfree(text);
 }
 
-static void write_tables_to_disk()
+// superseded records are allowed to pile up in proportion to the live ones, keeping compaction amortized O(1)
+static inline bool journal_needs_compaction()
 {
-    char *tables_path = obs_module_config_path("TABLES1.WAD");
+    return journal_records >= JOURNAL_COMPACT_RECORDS + 2u * table_count;
+}
 
-    FILE *f = os_fopen(tables_path, "wb");
-    if (f != NULL) {
+static void write_tables_header(FILE *f)
+{
+    char notice[TABLESFILE_HEADER_SIZE] = {0};
+    memcpy(notice, "|-This file cannot be read in HUMAN mode.", 41);
+    memcpy(&notice[TABLESFILE_HEADER_SIZE - 2], "-|", 2);
 
-        //blog(LOG_INFO, "writing %u table(s) to disk", table_count);
+    const uint32_t magic = JOURNAL_MAGIC;
 
-        char notice[TABLESFILE_HEADER_SIZE] = {0};
-        memcpy(notice, "|-This file cannot be read in HUMAN mode.", 41);
-        memcpy(&notice[TABLESFILE_HEADER_SIZE - 2], "-|", 2);
+    fwrite(notice, TABLESFILE_HEADER_SIZE, 1, f);
+    fwrite(&magic, 4, 1, f);
+}
 
-        fwrite(notice, TABLESFILE_HEADER_SIZE, 1, f);
-        fwrite(&table_count, 2, 1, f);
+// FNV-1a
+static uint32_t journal_checksum(uint32_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = data;
+    for (size_t i = 0u; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
 
-        if (table_count > 0u) {
+static uint32_t get_journal_checksum(const struct meltscr_journal_record *record, const uint8_t *data)
+{
+    uint32_t hash = journal_checksum(2166136261u, &record->type, sizeof(*record) - sizeof(record->checksum));
+    return journal_checksum(hash, data, record->data_size);
+}
 
-            size_t table_disk_size = sizeof(struct meltscr_table_packed);
+static bool journal_record_valid(const struct meltscr_journal_record *record)
+{
+    // the walk starts reading the values there, an empty pool is the only one starting at its end
+    if (record->position >= record->values_size && record->position != 0u) return false;
+
+    switch (record->type) {
+      case JOURNAL_RECORD_TABLE:
+      case JOURNAL_RECORD_BUFFER:
+        return record->data_size <= max_size && record->values_size == record->data_size;
+      case JOURNAL_RECORD_TABLE_REF:
+        return record->data_size == sizeof(uint64_t) && record->values_size <= max_size;
+      default:
+        return false;
+    }
+}
 
-            struct meltscr_table_packed *table_disk = bzalloc(table_disk_size);
-            struct meltscr_table *table;
+// 'data' is what follows the record, deduplicated values are referred to by hash
+static void get_journal_record(struct meltscr_journal_record *out, struct meltscr_table *in, const uint8_t **data)
+{
+    // value pools don't fit a record, they are regenerated anyway so only the head they've generated so far is kept.
+    // anything past what's been generated was never written, a pool nothing has been read from yet is kept empty
+    uint32_t size = in->values_size > max_size ? max_size : in->values_size;
+    if (size > in->values_generated) size = in->values_generated;
 
-            for (uint16_t i = 0u; i < table_count; i++) {
+    const bool interned = (in->state_flags & STATE_FLAG_INTERNED) != 0;
 
-                table = tables[i];
+    out->type = interned ? JOURNAL_RECORD_TABLE_REF : JOURNAL_RECORD_TABLE;
+    out->uuid = in->uuid;
+    out->position = size ? in->position % size : 0u;
+    out->values_size = size;
+    out->offsets_size = in->offsets_size;
+    out->death_mark = in->users == 0u ? STATE_FLAG_DEAD : 0u;
+    out->data_size = interned ? sizeof(uint64_t) : size;
 
-                if (table->users == 0u && (table->state_flags & STATE_FLAG_DEAD) != 0) {
-                    //obs_log(LOG_INFO, "table with uuid %" PRIu64 " removed due cleanup", table->uuid);
-                    continue;
-                }
+    *data = interned ? (const uint8_t *)&in->_values_buffer->hash : in->_values;
+    out->checksum = get_journal_checksum(out, *data);
+}
 
-                get_writable_table(table_disk, table);
-                fwrite(table_disk, table_disk_size, 1, f);
+static bool write_journal_buffer(FILE *f, struct meltscr_buffer *buffer)
+{
+    struct meltscr_journal_record record = {0};
 
-                fwrite(table->_values, max_slices, 1, f);
+    record.type = JOURNAL_RECORD_BUFFER;
+    record.uuid = buffer->hash;
+    record.values_size = buffer->size;
+    record.data_size = buffer->size;
+    record.checksum = get_journal_checksum(&record, buffer->data);
 
-                blog(LOG_INFO, "written table with uuid %" PRIu64, table->uuid);
-            }
+    buffer->journaled = fwrite(&record, sizeof(record), 1, f) == 1 && fwrite(buffer->data, buffer->size, 1, f) == 1;
+    return buffer->journaled;
+}
 
-            bfree(table_disk);
+// the journal is replayed by uuid, a table sharing one with another would be read back over it.
+// tables read from files written before uuids were unique get a new one, whoever used it finds the first table as they always did
+static void make_table_uuid_unique(struct meltscr_table *table)
+{
+    const struct meltscr_table *holder = get_table_by_uuid(table->uuid);
+    if (!holder || holder == table) return;
+
+    const uint64_t uuid = new_table_uuid();
+
+    obs_log(LOG_WARNING, "table with uuid %" PRIu64 " shares it with another one, saving it as %" PRIu64, table->uuid, uuid);
+    table->uuid = uuid;
+}
+
+// returns how many records it took, a deduplicated buffer goes in before the first table referring to it. 0 on failure
+static uint32_t write_journal_record(FILE *f, struct meltscr_table *table)
+{
+    uint32_t written = 0u;
+
+    make_table_uuid_unique(table);
+
+    struct meltscr_buffer *buffer = table->state_flags & STATE_FLAG_INTERNED ? table->_values_buffer : NULL;
+
+    if (buffer && !buffer->journaled) {
+        if (!write_journal_buffer(f, buffer)) return 0u;
+        written++;
+    }
+
+    struct meltscr_journal_record record;
+    const uint8_t *data;
+    get_journal_record(&record, table, &data);
+
+    if (fwrite(&record, sizeof(record), 1, f) != 1 || (record.data_size != 0u && fwrite(data, record.data_size, 1, f) != 1)) return 0u;
+
+    return written + 1u;
+}
+
+// rewrites the journal with one record per live table, dropping dead tables and superseded records
+static void compact_tables_journal()
+{
+    char *tables_path = obs_module_config_path(JOURNAL_FILE);
+    char *temp_path = obs_module_config_path(JOURNAL_FILE ".tmp");
+
+    FILE *f = os_fopen(temp_path, "wb");
+    if (f != NULL) {
+
+        bool success = true;
+        uint32_t written = 0u;
+
+        write_tables_header(f);
+
+        // the new file starts without any buffer, they go in again along with the first table using them.
+        // the previous file is still the journal if this one fails, so are the flags
+        bool *journaled = bmalloc(sizeof(bool) * (buffer_count + 1u));
+
+        for (uint32_t i = 0u; i < buffer_count; i++) {
+            journaled[i] = buffers[i]->journaled;
+            buffers[i]->journaled = false;
+        }
+
+        struct meltscr_table *table;
+
+        for (uint16_t i = 0u; i < table_count; i++) {
+
+            table = tables[i];
+
+            if (!table || (table->users == 0u && (table->state_flags & STATE_FLAG_DEAD) != 0)) continue;
+
+            const uint32_t records = write_journal_record(f, table);
+
+            success = records > 0u && success;
+            written += records;
+        }
+
+        success = fclose(f) == 0 && success;
+
+        if (success && os_rename(temp_path, tables_path) == 0) {
+            journal_records = written;
+            blog(LOG_INFO, "compacted tables journal to %u record(s)", written);
+        }
+        else {
+            for (uint32_t i = 0u; i < buffer_count; i++) buffers[i]->journaled = journaled[i];
+            obs_log(LOG_ERROR, "IO Error compacting tables journal, the previous one is kept");
         }
 
+        bfree(journaled);
+    }
+    else obs_log(LOG_ERROR, "IO Error writting tables: unable to write to file");
+
+    bfree(temp_path);
+    bfree(tables_path);
+}
+
+// appends the table's current state, the cost doesn't depend on how many tables there are
+static void journal_table(struct meltscr_table *table)
+{
+    // tables from the shared library, even once copied, belong to it
+    if (is_shared_table(table)) return;
+
+    // compacting writes this table too
+    if (journal_needs_compaction()) {
+        compact_tables_journal();
+        return;
+    }
+
+    char *tables_path = obs_module_config_path(JOURNAL_FILE);
+
+    FILE *f = os_fopen(tables_path, "ab");
+    if (f != NULL) {
+
+        const uint32_t records = write_journal_record(f, table);
+
+        if (!records) obs_log(LOG_ERROR, "IO Error appending table with uuid %" PRIu64, table->uuid);
+        else journal_records += records;
+
         fclose(f);
     }
     else obs_log(LOG_ERROR, "IO Error writting tables: unable to write to file");
@@ -295,7 +832,132 @@ static void write_tables_to_disk()
     bfree(tables_path);
 }
 
+// false for a reference to a buffer the journal doesn't hold
+static bool apply_journal_record(struct meltscr_journal_record *record, const uint8_t *data)
+{
+    if (record->type == JOURNAL_RECORD_BUFFER) {
+        // pinned until the replay ends, a table further on may refer to it after its last user moved away
+        struct meltscr_buffer *buffer = intern_buffer(data, record->data_size);
+
+        if (buffer && !buffer->journaled) {
+            buffer->journaled = true;
+            buffer->refs++;
+        }
+        return true;
+    }
+
+    const uint8_t *values = data;
+
+    if (record->type == JOURNAL_RECORD_TABLE_REF) {
+        uint64_t hash;
+        memcpy(&hash, data, sizeof(hash));
+
+        struct meltscr_buffer *buffer = get_buffer_by_hash(hash);
+        if (!buffer || buffer->size != record->values_size) return false;
+
+        values = buffer->data;
+    }
+
+    struct meltscr_table *table = get_private_table_by_uuid(record->uuid);
+
+    if (!table) {
+        table = bzalloc(sizeof(struct meltscr_table));
+        table->uuid = record->uuid;
+        table->_atlas_row = -1;
+
+        add_table(table);
+    }
+
+    // inline preset values get deduplicated too, journals written before buffers existed have them that way
+    if (record->type == JOURNAL_RECORD_TABLE_REF || is_preset_values(values, record->values_size)) intern_table_values(table, values, record->values_size);
+    else {
+        resize_table_values(table, max_size);
+        memcpy(table->_values, values, record->values_size);
+    }
+
+    table->position = record->position;
+    table->values_size = record->values_size;
+    table->values_generated = record->values_size;
+    table->offsets_size = record->offsets_size;
+    table->state_flags = (table->state_flags & STATE_FLAG_INTERNED) | (record->death_mark ? STATE_FLAG_DEAD : 0u) | STATE_FLAG_DIRT;
+
+    return true;
+}
+
+// replays the journal in order, later records win. Returns false if there's no journal to replay,
+// 'clean' is false if it ended in a truncated or corrupt record (which is ignored along with anything after it)
+static bool replay_tables_journal(bool *clean)
+{
+    char *tables_path = obs_module_config_path(JOURNAL_FILE);
+
+    FILE *f = os_fopen(tables_path, "rb");
+    bfree(tables_path);
+
+    if (f == NULL) return false;
+
+    uint32_t magic = 0u;
+
+    fseek(f, TABLESFILE_HEADER_SIZE, SEEK_SET);
+    if (fread(&magic, 4, 1, f) != 1 || magic != JOURNAL_MAGIC) {
+        obs_log(LOG_ERROR, "Tables journal has an unknown format, ignoring it");
+        fclose(f);
+        return false;
+    }
+
+    struct meltscr_journal_record record;
+    uint8_t *data = bmalloc(max_size);
+
+    *clean = true;
+    journal_records = 0u;
+
+    for (;;) {
+
+        int64_t offset = os_ftelli64(f);
+
+        if (fread(&record, sizeof(record), 1, f) != 1) {
+            // a partial header is a torn write, a clean end reads nothing at all
+            *clean = feof(f) && os_ftelli64(f) == offset;
+            if (!*clean) obs_log(LOG_WARNING, "Tables journal ends in a truncated record at offset %" PRId64 ", ignoring it", offset);
+            break;
+        }
+
+        if (!journal_record_valid(&record) || fread(data, 1, record.data_size, f) != record.data_size ||
+            get_journal_checksum(&record, data) != record.checksum || !apply_journal_record(&record, data)) {
+            obs_log(LOG_WARNING, "Tables journal has a damaged record at offset %" PRId64 ", ignoring the rest of it", offset);
+            *clean = false;
+            break;
+        }
+
+        journal_records++;
+    }
+
+    // drops the pins, buffers no table ended up using go with them
+    for (uint32_t i = buffer_count; i > 0u; i--) {
+        if (buffers[i - 1u]->journaled) release_buffer(buffers[i - 1u]);
+    }
+
+    bfree(data);
+    fclose(f);
+
+    blog(LOG_INFO, "replayed %u journal record(s) into %u table(s) sharing %u buffer(s)", journal_records, table_count, buffer_count);
+
+    return true;
+}
+
+static void read_legacy_tables_from_disk();
+
+// journals are compacted on load if they came from the old file, ended badly or grew too long
 static void read_tables_from_disk()
+{
+    bool clean = false;
+
+    if (!replay_tables_journal(&clean)) read_legacy_tables_from_disk();
+
+    if (!clean || journal_needs_compaction()) compact_tables_journal();
+}
+
+// TABLES1.WAD, which was fully rewritten on every change
+static void read_legacy_tables_from_disk()
 {
     char *tables_path = obs_module_config_path("TABLES1.WAD");
 
@@ -348,9 +1010,9 @@ static void read_tables_from_disk()
                 }
 
                 table = bmalloc(table_size);
-                uint8_t *offsets = bmalloc(max_size);
 
-                get_runtime_table(table, table_disk, values, offsets);
+                get_runtime_table(table, table_disk, values);
+                if (table->values_size <= max_slices && is_preset_values(values, table->values_size)) intern_table_values(table, values, table->values_size);
 
                 blog(LOG_INFO, "read table with uuid %" PRIu64, table->uuid);
 
@@ -385,3 +1047,25 @@ static inline float cubic_ease_in_out(float t)
     float _tmp = (2.0f * t - 2.0f);
     return (t - 1.0f) * _tmp * _tmp + 1.0f;
 }
+
+static inline float bounce_ease_out(float t)
+{
+    if (t < 1.0f / 2.75f) return 7.5625f * t * t;
+    if (t < 2.0f / 2.75f) { t -= 1.5f / 2.75f; return 7.5625f * t * t + .75f; }
+    if (t < 2.5f / 2.75f) { t -= 2.25f / 2.75f; return 7.5625f * t * t + .9375f; }
+    t -= 2.625f / 2.75f;
+    return 7.5625f * t * t + .984375f;
+}
+
+// distance a slice has moved after travelling 's' at the linear speed, past 1 it's off screen anyway
+static inline float motion_curve(int motion, float s)
+{
+    if (s >= 1.0f) return s;
+
+    switch (motion) {
+      default: return s;
+      case 1: return s * s; // gravity
+      case 2: return 1.0f - (1.0f - s) * (1.0f - s); // ease-out
+      case 3: return bounce_ease_out(s);
+    }
+}
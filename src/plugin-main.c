@@ -14,6 +14,7 @@ MODULE_EXPORT const char *obs_module_description(void)
 }
 
 extern struct obs_source_info meltscr_transition;
+extern void meltscr_register_module_procs(void);
 
 const uint32_t 
           min_slices= 2u,
@@ -21,20 +22,64 @@ const uint32_t
           min_steps= 4u,
           max_steps= 64u,
           max_length= 64u,
-          max_size= 4096u;
-
-uint8_t original_values[256] = {0,   8,   109, 220, 222, 241, 149, 107, 75,  248, 254, 140, 16,  66,  74,  21,  211, 47,  80,  242, 154, 27,  205, 128, 161, 89,  77,  36,  95,  110, 85,  48,
-                                212, 140, 211, 249, 22,  79,  200, 50,  28,  188, 52,  140, 202, 120, 68,  145, 62,  70,  184, 190, 91,  197, 152, 224, 149, 104, 25,  178, 252, 182, 202, 182,
-                                141, 197, 4,   81,  181, 242, 145, 42,  39,  227, 156, 198, 225, 193, 219, 93,  122, 175, 249, 0,   175, 143, 70,  239, 46,  246, 163, 53,  163, 109, 168, 135,
-                                2,   235, 25,  92,  20,  145, 138, 77,  69,  166, 78,  176, 173, 212, 166, 113, 94,  161, 41,  50,  239, 49,  111, 164, 70,  60,  2,   37,  171, 75,  136, 156,
-                                11,  56,  42,  146, 138, 229, 73,  146, 77,  61,  98,  196, 135, 106, 63,  197, 195, 86,  96,  203, 113, 101, 170, 247, 181, 113, 80,  250, 108, 7,   255, 237,
-                                129, 226, 79,  107, 112, 166, 103, 241, 24,  223, 239, 120, 198, 58,  60,  82,  128, 3,   184, 66,  143, 224, 145, 224, 81,  206, 163, 45,  63,  90,  168, 114,
-                                59,  33,  159, 95,  28,  139, 123, 98,  125, 196, 15,  70,  194, 253, 54,  14,  109, 226, 71,  17,  161, 93,  186, 87,  244, 138, 20,  52,  123, 251, 26,  36,
-                                17,  46,  52,  231, 232, 76,  31,  221, 84,  37,  216, 165, 212, 106, 197, 242, 98,  43,  39,  175, 254, 145, 190, 84,  118, 222, 187, 136, 120, 163, 236, 249};
+          max_size= 4096u,
+          max_pool_size= 1u << 22;
 
 struct meltscr_table **tables;
 uint16_t table_count= 0u;
 
+struct meltscr_buffer **buffers;
+uint32_t buffer_count= 0u;
+
+uint32_t journal_records= 0u;
+
+struct meltscr_atlas atlas;
+
+struct meltscr_histogram start_latency;
+struct meltscr_histogram render_time;
+struct meltscr_histogram gpu_time[RENDER_CLASSES];
+
+static const char *render_class_names[RENDER_CLASSES] = {"melt pass GPU (<=720p)", "melt pass GPU (<=1080p)", "melt pass GPU (<=1440p)", "melt pass GPU (>1440p)"};
+
+void report_stats(void)
+{
+    obs_log(LOG_INFO, "Transition stats:");
+
+    histogram_report(&start_latency, "transition start");
+    histogram_report(&render_time, "frame render");
+
+    for (int i = 0; i < RENDER_CLASSES; i++) histogram_report(&gpu_time[i], render_class_names[i]);
+
+    // only what the plugin itself holds, libobs' allocation counter covers every module in the process
+    size_t allocations = (tables ? 1u : 0u) + (buffers ? 1u : 0u);
+
+    size_t table_bytes = 0u;
+    for (uint16_t i = 0u; i < table_count; i++) {
+        if (!tables[i]) continue;
+
+        // values of interned and shared tables aren't theirs, those have no capacity
+        table_bytes += sizeof(struct meltscr_table) + tables[i]->values_capacity;
+        allocations += tables[i]->values_capacity ? 2u : 1u;
+    }
+
+    // the shared library's values live in its mapping, until a Refresh gives the table a copy of its own
+    for (uint32_t i = 0u; i < shared_table_count; i++) {
+        table_bytes += sizeof(struct meltscr_table) + shared_tables[i]->values_capacity;
+        allocations += shared_tables[i]->values_capacity ? 2u : 1u;
+    }
+    if (shared_tables) allocations++;
+
+    size_t buffer_bytes = 0u;
+    for (uint32_t i = 0u; i < buffer_count; i++) buffer_bytes += sizeof(struct meltscr_buffer) + buffers[i]->size;
+    allocations += 2u * buffer_count;
+
+    const size_t atlas_bytes = ((size_t)ATLAS_WIDTH + sizeof(struct meltscr_table *)) * atlas.rows;
+    if (atlas.shadow) allocations += 2u;
+
+    blog(LOG_INFO, "%u table(s) holding %zu bytes, %u shared buffer(s) holding %zu bytes, offsets atlas holding %zu bytes, %zu allocation(s) in total",
+         table_count, table_bytes, buffer_count, buffer_bytes, atlas_bytes, allocations);
+}
+
 bool obs_module_load(void)
 {
     obs_log(LOG_INFO, "Booting up plugin, v%s", PLUGIN_VERSION);
@@ -45,9 +90,11 @@ bool obs_module_load(void)
     bfree(config_dir);
 
     read_tables_from_disk();
+    load_shared_tables();
 
     // register transition
     obs_register_source(&meltscr_transition);
+    meltscr_register_module_procs();
 
     return true;
 }
@@ -56,7 +103,9 @@ void obs_module_unload(void)
 {
     obs_log(LOG_INFO, "Shutting down...");
 
-    write_tables_to_disk();
+    report_stats();
+
+    compact_tables_journal();
 
     if (table_count > 0u) {
 
@@ -68,9 +117,7 @@ void obs_module_unload(void)
 
             if (!table) continue;
 
-            if(table->_values) bfree(table->_values);
-            if(table->_offsets) bfree(table->_offsets);
-            if(table->_texture) gs_texture_destroy(table->_texture);
+            release_table_values(table);
 
             bfree(table);
         }
@@ -80,5 +127,21 @@ void obs_module_unload(void)
         blog(LOG_INFO, "freed %u table(s)", table_count);
     }
 
+    unload_shared_tables();
+    close_capture_log();
+
+    // every table has released its buffer by now
+    bfree(buffers);
+
+    if (atlas.texture || atlas.staging) {
+        obs_enter_graphics();
+        if (atlas.texture) gs_texture_destroy(atlas.texture);
+        if (atlas.staging) gs_texture_destroy(atlas.staging);
+        obs_leave_graphics();
+    }
+
+    bfree(atlas.shadow);
+    bfree(atlas.owners);
+
     obs_log(LOG_INFO, "Finished shutting down.");
 }
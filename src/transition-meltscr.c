@@ -1,4 +1,6 @@
 #include <graphics/vec2.h>
+#include <graphics/vec4.h>
+#include <util/threading.h>
 #include "plugin-common.h"
 
 #define S_PRIV_TABLEUUID "uuid"
@@ -13,12 +15,34 @@
 #define S_PROP_RESOLUTION "table_size"
 #define S_PROP_SWAPPOINT "swap_point"
 #define S_PROP_AUDIOMODE "audio_mode"
+#define S_PROP_ADAPTIVE "adaptive_quality"
+#define S_PROP_CAPTURE "capture_log"
+#define S_PROP_GPUSTATS "gpu_stats"
+#define S_PROP_FADECOLOR "fade_color"
+#define S_PROP_FADEAMOUNT "fade_amount"
+#define S_PROP_SHADEEXPOSED "shade_exposed"
+#define S_PROP_SHADEEDGE "shade_edge"
+#define S_PROP_MOTION "motion"
 
 #define S_BTN_REFRESHTABLE "table_refresh"
 //#define S_BTN_HELP "help"
 
 #define S_PROPGRP_FIXEDTABLE "grp_fixed_table"
 
+#define VARIANT_FADE 0b001
+#define VARIANT_SHADE 0b010
+#define VARIANT_MOTION 0b100
+
+#define MOTION_SAMPLES 64
+#define MOTION_RANGE 2.0f // 1 + max factor
+
+#define SHADE_EDGE_WIDTH .08f // screen fraction the edge shading fades over
+
+#define GOVERNOR_MAX_LEVEL 2 // each level halves the melt pass resolution
+#define GOVERNOR_GPU_BUDGET .25f // fraction of the frame interval the melt pass may take
+#define GOVERNOR_HEADROOM .2f // fraction of the budget under which the next level up is tried, it costs ~4x the pixels
+#define GOVERNOR_MIN_SAMPLES 2 // melt pass timings at a level before it's judged halfway through a transition
+
 struct meltscr_info {
     obs_source_t *source;
     gs_effect_t *effect;
@@ -27,11 +51,16 @@ struct meltscr_info {
       *a_tex,
       *b_tex,
       *c_tex,
+      *d_tex,
       *factor,
       *sizes,
+      *atlas,
       *dir,
       *dir_mask,
-      *progress;
+      *progress,
+      *fade_color,
+      *shade,
+      *motion;
 
     bool _use_original;
 
@@ -44,15 +73,73 @@ struct meltscr_info {
     int _table_type;
 
     int _noise_resolution;
-    int _tex_resolution;
     struct meltscr_table *_table_ptr;
 
     uint8_t _slice_offsets;
 
+    // pattern of its own once the atlas has no row left for its table
+    gs_texture_t *_offsets_texture;
+    uint8_t *_offsets;
+
     int _audio_mode;
     float _audio_swap_point;
+
+    int _variant;
+    struct vec4 _fade_color;
+    float _fade_amount;
+    float _shade_exposed;
+    float _shade_edge;
+
+    int _motion;
+    int _motion_rows;
+    uint16_t *_motion_data;
+    gs_texture_t *_motion_texture;
+
+    bool _adaptive;
+    int _quality_level;
+    int _render_level; // the level the current transition renders at, only ever lowered until it ends
+    float _frame_budget_ms;
+    float _gpu_total_ms;
+    uint32_t _gpu_samples;
+    bool _gpu_stale;
+    uint32_t _dropped_frames; // lagged and skipped frames libobs had counted at the last look
+    bool _frames_dropped; // some of them during the current transition
+
+    gs_texrender_t *_scaled_render;
+    enum gs_color_format _scaled_format;
+
+    bool _gpu_stats;
+    gs_timer_t *_gpu_timer;
+    gs_timer_range_t *_gpu_range;
+
+    gs_texrender_t *_a_render;
+    enum gs_color_format _a_format;
+    bool _gpu_pending;
+
+    bool _prebaked;
+    bool _active; // between transition_start and transition_stop
+
+    bool _capture;
+    uint32_t _capture_id;
+    struct meltscr_capture_frame _capture_frame;
+
+    struct meltscr_info *_next;
 };
 
+// direct path, indexed by whether the motion texture is used
+static const char *over_techniques[] = {"MeltScreenOver", "MeltScreenMotionOver"};
+
+// indexed by VARIANT_* flags
+static const char *techniques[] = {"MeltScreen",       "MeltScreenFade",       "MeltScreenShade",       "MeltScreenFadeShade",
+                                   "MeltScreenMotion", "MeltScreenMotionFade", "MeltScreenMotionShade", "MeltScreenMotionFadeShade"};
+
+static struct meltscr_info *instances = NULL;
+static uint32_t instance_counter = 0u;
+static pthread_mutex_t instances_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// table values and patterns are built from settings changes, warm-ups and transition starts, which may each run on another thread
+static pthread_mutex_t patterns_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static void meltscr_table_mark_dirty(void *data)
 {
     struct meltscr_info *dwipe = data;
@@ -75,20 +162,121 @@ static void meltscr_create_table(void* data)
 
         int resolution = dwipe->_noise_resolution == -1 ? slices_resolution : dwipe->_noise_resolution;
 
-        dwipe->_tex_resolution = imax(slices_resolution, resolution);
-        table->values_size = (uint16_t)(resolution * resolution);
         table->offsets_size = slices;
 
-        table->position = 2;
+        dwipe->_prebaked = false;
+
+        // a fixed pattern from the shared library is used as it is, any other mode needs its own values
+        if (table->state_flags & STATE_FLAG_SHARED) {
+            if (dwipe->_table_type == 1) return;
+            make_table_private(table);
+        }
+
+        // dynamic tables stream through a large pool instead of regenerating on every transition
+        if (dwipe->_table_type == 2) reset_table_pool(table);
+        else {
+            resize_table_values(table, max_size);
+
+            table->values_size = (uint32_t)(resolution * resolution);
+            table->position = 2;
+
+            if (dwipe->_table_type == 0) {
+                memcpy(table->_values, original_values, 256);
+                table->values_generated = table->values_size;
+
+                // every DooM table ends up on the same buffer, a Refresh or a switch to another mode copies it first.
+                // random values never match another table's, they stay private
+                intern_table_values(table, table->_values, table->values_size);
+            }
+            else generate_table_values(table);
+        }
+
+        journal_table(table);
+    }
+}
+
+// a preset applies to any table holding its values, the walk over them only depends on these parameters
+static const struct meltscr_baked_preset *meltscr_find_baked_preset(struct meltscr_info *dwipe)
+{
+    struct meltscr_table *table = dwipe->_table_ptr;
+
+    if (!table) return NULL;
+
+    for (size_t i = 0u; i < baked_preset_count; i++) {
+
+        const struct meltscr_baked_preset *preset = &baked_presets[i];
+
+        if (preset->slices == table->offsets_size && preset->steps == dwipe->_steps && fabsf(preset->increment - dwipe->_increment) < 1e-4f &&
+            fabsf(preset->factor - dwipe->_factor) < 1e-4f && preset->values_size == table->values_size &&
+            memcmp(preset->values, table->_values, preset->values_size) == 0)
+            return preset;
+    }
+    return NULL;
+}
+
+// displacement of every slice along MOTION_SAMPLES points of the transition, so curved motion costs a single filtered fetch.
+// needs the graphics context
+static void meltscr_create_motion_texture(struct meltscr_info *dwipe, const uint8_t *offsets, int slices)
+{
+    if (slices != dwipe->_motion_rows) {
+        dwipe->_motion_data = brealloc(dwipe->_motion_data, sizeof(uint16_t) * MOTION_SAMPLES * slices);
+        if (dwipe->_motion_texture) gs_texture_destroy(dwipe->_motion_texture);
+        dwipe->_motion_texture = NULL;
+        dwipe->_motion_rows = slices;
+    }
+
+    const float length = 1.0f + dwipe->_factor;
+
+    for (int i = 0; i < slices; i++) {
+
+        uint16_t *row = &dwipe->_motion_data[i * MOTION_SAMPLES];
+        const float offset = offsets[i] / 255.0f;
+
+        for (int k = 0; k < MOTION_SAMPLES; k++) {
+            float s = fmaxf(.0f, length * k / (MOTION_SAMPLES - 1) - offset);
+            float displacement = fminf(motion_curve(dwipe->_motion, s), MOTION_RANGE);
+            row[k] = (uint16_t)lroundf(displacement / MOTION_RANGE * 65535.0f);
+        }
+    }
+
+    if (dwipe->_motion_texture) gs_texture_set_image(dwipe->_motion_texture, (const uint8_t *)dwipe->_motion_data, MOTION_SAMPLES * sizeof(uint16_t), false);
+    else {
+        const uint8_t *texdata[] = { (const uint8_t *)dwipe->_motion_data };
+        dwipe->_motion_texture = gs_texture_create(MOTION_SAMPLES, slices, GS_R16, 1, texdata, GS_DYNAMIC);
+    }
+}
 
-        if (dwipe->_table_type == 0) memcpy(table->_values, original_values, 256);
-        else generate_table_values(table);
+// a full atlas only has rows for tables somebody uses, an instance left without one draws from a texture of its own.
+// needs the graphics context
+static void meltscr_create_offsets_texture(struct meltscr_info *dwipe, const uint8_t *offsets, uint16_t slices)
+{
+    if (!dwipe->_offsets) dwipe->_offsets = bzalloc(ATLAS_WIDTH);
+    memcpy(dwipe->_offsets, offsets, slices);
 
-        obs_log(LOG_INFO, "Saving tables...");
-        write_tables_to_disk();
+    if (dwipe->_offsets_texture) gs_texture_set_image(dwipe->_offsets_texture, dwipe->_offsets, ATLAS_WIDTH, false);
+    else {
+        const uint8_t *texdata[] = { dwipe->_offsets };
+        dwipe->_offsets_texture = gs_texture_create(ATLAS_WIDTH, 1, GS_R8, 1, texdata, GS_DYNAMIC);
     }
 }
 
+// needs the graphics context
+static void meltscr_drop_offsets_texture(struct meltscr_info *dwipe)
+{
+    if (dwipe->_offsets_texture) gs_texture_destroy(dwipe->_offsets_texture);
+    bfree(dwipe->_offsets);
+
+    dwipe->_offsets_texture = NULL;
+    dwipe->_offsets = NULL;
+}
+
+// whether a pattern was built for the next transition, in the atlas or not
+static bool meltscr_has_offsets(struct meltscr_info *dwipe)
+{
+    struct meltscr_table *table = dwipe->_table_ptr;
+    return (table && table->_atlas_row >= 0) || dwipe->_offsets_texture;
+}
+
 static void meltscr_create_texture(void *data)
 {
     struct meltscr_info *dwipe = data;
@@ -98,20 +286,129 @@ static void meltscr_create_texture(void *data)
 
         //blog(LOG_INFO, "generating offsets+texture for table %llu &[0x%llx]", table->uuid, dwipe->_table_ptr);
 
-        generate_table_offsets(table, dwipe->_steps, dwipe->_increment, dwipe->_factor);
+        const uint8_t *texdata;
+        uint8_t offsets[ATLAS_WIDTH];
 
-        if (table->_texture) gs_texture_destroy(table->_texture);
+        const struct meltscr_baked_preset *preset = meltscr_find_baked_preset(dwipe);
 
-        int resolution = dwipe->_tex_resolution;
-        const uint8_t *texdata = table->_offsets;
-        const uint8_t *offsets[] = { texdata };
+        if (preset) {
+            // same walk as generate_table_offsets, already done at build time
+            uint32_t phase = table->position % preset->values_size;
+            texdata = &preset->phases[phase * preset->slices];
+            table->position = (phase + preset->slices - 1u) % preset->values_size;
+        }
+        else {
+            stream_table_pool(table, table->offsets_size);
+            generate_table_offsets(table, offsets, dwipe->_steps, dwipe->_increment, dwipe->_factor);
+            texdata = offsets;
+        }
 
+        // the render thread uploads the atlas, writing to it has to wait for the frame in flight
         obs_enter_graphics();
-        table->_texture = gs_texture_create(resolution, resolution, GS_R8, 1, offsets, 0);
+        if (atlas_write_row(table, texdata, table->offsets_size)) meltscr_drop_offsets_texture(dwipe);
+        else meltscr_create_offsets_texture(dwipe, texdata, table->offsets_size);
+        if (dwipe->_motion) meltscr_create_motion_texture(dwipe, texdata, table->offsets_size);
         obs_leave_graphics();
     }
 }
 
+#pragma region -------------------------------------------------------------------------------------- WARM-UP
+
+// builds the pattern and texture the next transition will use, so starting it doesn't have to.
+// in Dynamic mode the next transition plays the pattern built here, the ones after it get a fresh one as usual
+static bool meltscr_warm_up(struct meltscr_info *dwipe)
+{
+    struct meltscr_table *table = dwipe->_table_ptr;
+
+    if (!table || !dwipe->effect) return false;
+
+    pthread_mutex_lock(&patterns_mutex);
+
+    // a transition in progress keeps drawing the pattern it started with, rebuilding it would change it halfway
+    if (!dwipe->_active && !dwipe->_prebaked) {
+        // hold the graphics context so the texture isn't swapped under a frame being rendered,
+        // and upload the row while it's held so the first frame doesn't have to
+        obs_enter_graphics();
+        meltscr_create_texture(dwipe);
+        atlas_upload();
+        obs_leave_graphics();
+
+        dwipe->_prebaked = meltscr_has_offsets(dwipe);
+    }
+
+    const bool ready = dwipe->_prebaked;
+
+    pthread_mutex_unlock(&patterns_mutex);
+
+    return ready;
+}
+
+static void meltscr_proc_warm_up(void *data, calldata_t *cd)
+{
+    calldata_set_bool(cd, "ready", meltscr_warm_up(data));
+}
+
+static void meltscr_proc_is_ready(void *data, calldata_t *cd)
+{
+    struct meltscr_info *dwipe = data;
+    calldata_set_bool(cd, "ready", dwipe->_prebaked);
+}
+
+static void meltscr_proc_warm_up_all(void *data, calldata_t *cd)
+{
+    int ready = 0, total = 0;
+
+    pthread_mutex_lock(&instances_mutex);
+    for (struct meltscr_info *dwipe = instances; dwipe; dwipe = dwipe->_next) {
+        if (meltscr_warm_up(dwipe)) ready++;
+        total++;
+    }
+    pthread_mutex_unlock(&instances_mutex);
+
+    obs_log(LOG_INFO, "warmed up %d of %d transition(s)", ready, total);
+
+    calldata_set_int(cd, "ready", ready);
+    calldata_set_int(cd, "total", total);
+
+    UNUSED_PARAMETER(data);
+}
+
+static void meltscr_proc_ready_all(void *data, calldata_t *cd)
+{
+    int ready = 0, total = 0;
+
+    pthread_mutex_lock(&instances_mutex);
+    for (struct meltscr_info *dwipe = instances; dwipe; dwipe = dwipe->_next) {
+        if (dwipe->_prebaked) ready++;
+        total++;
+    }
+    pthread_mutex_unlock(&instances_mutex);
+
+    calldata_set_int(cd, "ready", ready);
+    calldata_set_int(cd, "total", total);
+
+    UNUSED_PARAMETER(data);
+}
+
+static void meltscr_proc_report_stats(void *data, calldata_t *cd)
+{
+    report_stats();
+
+    UNUSED_PARAMETER(data);
+    UNUSED_PARAMETER(cd);
+}
+
+void meltscr_register_module_procs(void)
+{
+    proc_handler_t *ph = obs_get_proc_handler();
+
+    proc_handler_add(ph, "void meltscr_report_stats()", meltscr_proc_report_stats, NULL);
+    proc_handler_add(ph, "void meltscr_warm_up_all(out int ready, out int total)", meltscr_proc_warm_up_all, NULL);
+    proc_handler_add(ph, "void meltscr_ready_all(out int ready, out int total)", meltscr_proc_ready_all, NULL);
+}
+
+#pragma endregion
+
 void* meltscr_create(obs_data_t *settings, obs_source_t *source)
 {
     struct meltscr_info *dwipe;
@@ -132,23 +429,31 @@ void* meltscr_create(obs_data_t *settings, obs_source_t *source)
 
     dwipe = bzalloc(sizeof(*dwipe));
 
+    obs_enter_graphics();
+    dwipe->_gpu_timer = gs_timer_create();
+    dwipe->_gpu_range = gs_timer_range_create();
+    obs_leave_graphics();
+
     dwipe->_table_type = -1;
     dwipe->_table_ptr = NULL;
 
-    dwipe->_tex_resolution = 1;
-
     dwipe->source = source;
     dwipe->effect = effect;
 
     dwipe->a_tex = gs_effect_get_param_by_name(effect, "tex_a");
     dwipe->b_tex = gs_effect_get_param_by_name(effect, "tex_b");
     dwipe->c_tex = gs_effect_get_param_by_name(effect, "tex_c");
+    dwipe->d_tex = gs_effect_get_param_by_name(effect, "tex_d");
 
     dwipe->factor = gs_effect_get_param_by_name(effect, "factor");
     dwipe->sizes = gs_effect_get_param_by_name(effect, "sizes");
+    dwipe->atlas = gs_effect_get_param_by_name(effect, "atlas");
     dwipe->dir = gs_effect_get_param_by_name(effect, "dir");
     dwipe->dir_mask = gs_effect_get_param_by_name(effect, "dir_mask");
     dwipe->progress = gs_effect_get_param_by_name(effect, "progress");
+    dwipe->fade_color = gs_effect_get_param_by_name(effect, "fade_color");
+    dwipe->shade = gs_effect_get_param_by_name(effect, "shade");
+    dwipe->motion = gs_effect_get_param_by_name(effect, "motion");
 
     obs_data_set_default_int(settings, S_PRIV_TABLEUUID, 0LL);
 
@@ -163,61 +468,449 @@ void* meltscr_create(obs_data_t *settings, obs_source_t *source)
     obs_data_set_default_int(settings, S_PROP_RESOLUTION, 16);
     obs_data_set_default_int(settings, S_PROP_AUDIOMODE, 3);
     obs_data_set_default_int(settings, S_PROP_SWAPPOINT, 50);
+    obs_data_set_default_bool(settings, S_PROP_ADAPTIVE, false);
+    obs_data_set_default_bool(settings, S_PROP_CAPTURE, false);
+    obs_data_set_default_bool(settings, S_PROP_GPUSTATS, false);
+    obs_data_set_default_int(settings, S_PROP_FADECOLOR, 0xFF000000);
+    obs_data_set_default_int(settings, S_PROP_FADEAMOUNT, 0);
+    obs_data_set_default_int(settings, S_PROP_SHADEEXPOSED, 0);
+    obs_data_set_default_int(settings, S_PROP_SHADEEDGE, 0);
+    obs_data_set_default_int(settings, S_PROP_MOTION, 0);
 
     obs_source_update(source, settings);
 
+    proc_handler_t *ph = obs_source_get_proc_handler(source);
+    proc_handler_add(ph, "void warm_up(out bool ready)", meltscr_proc_warm_up, dwipe);
+    proc_handler_add(ph, "void is_ready(out bool ready)", meltscr_proc_is_ready, dwipe);
+
+    pthread_mutex_lock(&instances_mutex);
+    dwipe->_next = instances;
+    dwipe->_capture_id = ++instance_counter;
+    instances = dwipe;
+    pthread_mutex_unlock(&instances_mutex);
+
     return dwipe;
 }
 
+#pragma region -------------------------------------------------------------------------------------- GOVERNOR
+
+static void meltscr_governor_set_level(struct meltscr_info *dwipe, int level, const char *reason)
+{
+    dwipe->_quality_level = level;
+
+    obs_log(LOG_INFO, "'%s': quality level %d (1/%d resolution), %s", obs_source_get_name(dwipe->source), level, 1 << level, reason);
+}
+
+// frames the render thread didn't get to plus the ones the output skipped, what an overloaded machine shows first
+static uint32_t meltscr_dropped_frames(void)
+{
+    video_t *video = obs_get_video();
+    return obs_get_lagged_frames() + (video ? video_output_get_skipped_frames(video) : 0u);
+}
+
+// timings gathered so far were taken at the previous level, a query still in flight too
+static void meltscr_governor_reset_samples(struct meltscr_info *dwipe)
+{
+    dwipe->_gpu_total_ms = .0f;
+    dwipe->_gpu_samples = 0u;
+    dwipe->_gpu_stale = dwipe->_gpu_pending;
+}
+
+// judges the transition that just played by its melt pass GPU time and whether frames were dropped during it.
+// a lower level is only tried back after a transition that dropped none
+static void meltscr_governor_start(struct meltscr_info *dwipe)
+{
+    struct obs_video_info ovi;
+
+    dwipe->_frame_budget_ms = obs_get_video_info(&ovi) && ovi.fps_num ? 1000.0f * ovi.fps_den / ovi.fps_num * GOVERNOR_GPU_BUDGET : 4.0f;
+
+    if (dwipe->_gpu_samples) {
+        const float gpu_ms = dwipe->_gpu_total_ms / dwipe->_gpu_samples;
+
+        char reason[96];
+
+        if (gpu_ms > dwipe->_frame_budget_ms && dwipe->_quality_level < GOVERNOR_MAX_LEVEL) {
+            snprintf(reason, sizeof(reason), "melt pass took %.2fms over a %.2fms budget", gpu_ms, dwipe->_frame_budget_ms);
+            meltscr_governor_set_level(dwipe, dwipe->_quality_level + 1, reason);
+        }
+        else if (gpu_ms < dwipe->_frame_budget_ms * GOVERNOR_HEADROOM && dwipe->_quality_level > 0 && !dwipe->_frames_dropped) {
+            snprintf(reason, sizeof(reason), "headroom recovered (%.2fms)", gpu_ms);
+            meltscr_governor_set_level(dwipe, dwipe->_quality_level - 1, reason);
+        }
+    }
+
+    meltscr_governor_reset_samples(dwipe);
+
+    // frames dropped between transitions aren't the melt pass' doing
+    dwipe->_dropped_frames = meltscr_dropped_frames();
+    dwipe->_frames_dropped = false;
+}
+
+// once per frame of a transition, before the frame picks its path. lowering the render resolution halfway
+// through keeps the pattern and progress, the scene just gets coarser. it's never raised back before the end
+static void meltscr_governor_frame(struct meltscr_info *dwipe)
+{
+    const uint32_t dropped = meltscr_dropped_frames();
+    const uint32_t new_drops = dropped - dwipe->_dropped_frames;
+
+    dwipe->_dropped_frames = dropped;
+    if (new_drops) dwipe->_frames_dropped = true;
+
+    if (dwipe->_render_level >= GOVERNOR_MAX_LEVEL) return;
+
+    char reason[96];
+
+    if (new_drops) snprintf(reason, sizeof(reason), "%u frame(s) lagged or skipped mid-transition", new_drops);
+    else if (dwipe->_gpu_samples >= GOVERNOR_MIN_SAMPLES && dwipe->_gpu_total_ms / dwipe->_gpu_samples > dwipe->_frame_budget_ms) {
+        snprintf(reason, sizeof(reason), "melt pass took %.2fms over a %.2fms budget mid-transition", dwipe->_gpu_total_ms / dwipe->_gpu_samples,
+                 dwipe->_frame_budget_ms);
+    }
+    else return;
+
+    meltscr_governor_set_level(dwipe, dwipe->_render_level + 1, reason);
+    dwipe->_render_level = dwipe->_quality_level;
+
+    meltscr_governor_reset_samples(dwipe);
+}
+
+// polls the timer queried on a previous frame, returns false while the GPU hasn't delivered it yet
+static bool meltscr_gpu_poll(struct meltscr_info *dwipe, float *gpu_ms)
+{
+    uint64_t ticks, frequency;
+    bool disjoint;
+
+    if (!gs_timer_range_get_data(dwipe->_gpu_range, &disjoint, &frequency)) return false;
+    if (!gs_timer_get_data(dwipe->_gpu_timer, &ticks)) return false;
+
+    dwipe->_gpu_pending = false;
+
+    if (disjoint || frequency == 0u) return false;
+
+    *gpu_ms = (float)(1000.0 * (double)ticks / (double)frequency);
+    return true;
+}
+
+static void meltscr_governor_update(struct meltscr_info *dwipe, float gpu_ms)
+{
+    if (dwipe->_gpu_stale) {
+        dwipe->_gpu_stale = false;
+        return;
+    }
+
+    dwipe->_gpu_total_ms += gpu_ms;
+    dwipe->_gpu_samples++;
+}
+
+// a lowered level draws the melt pass into a smaller target, the upscale to the output is a single fetch per pixel.
+// needs the graphics context
+static bool meltscr_scaled_begin(struct meltscr_info *dwipe, uint32_t cx, uint32_t cy)
+{
+    const enum gs_color_space space = gs_get_color_space();
+    const enum gs_color_format format = gs_get_format_from_space(space);
+
+    if (!dwipe->_scaled_render || dwipe->_scaled_format != format) {
+        if (dwipe->_scaled_render) gs_texrender_destroy(dwipe->_scaled_render);
+        dwipe->_scaled_render = gs_texrender_create(format, GS_ZS_NONE);
+        dwipe->_scaled_format = format;
+    }
+
+    gs_texrender_reset(dwipe->_scaled_render);
+
+    const uint32_t scaled_cx = cx >> dwipe->_render_level, scaled_cy = cy >> dwipe->_render_level;
+
+    if (!scaled_cx || !scaled_cy || !gs_texrender_begin_with_color_space(dwipe->_scaled_render, scaled_cx, scaled_cy, space)) return false;
+
+    // the melt pass covers every pixel opaquely, nothing to clear
+    gs_ortho(.0f, (float)cx, .0f, (float)cy, -100.0f, 100.0f);
+    return true;
+}
+
+static void meltscr_scaled_end(struct meltscr_info *dwipe, uint32_t cx, uint32_t cy)
+{
+    gs_texrender_end(dwipe->_scaled_render);
+
+    gs_texture_t *tex = gs_texrender_get_texture(dwipe->_scaled_render);
+    gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+
+    gs_effect_set_texture_srgb(gs_effect_get_param_by_name(effect, "image"), tex);
+
+    while (gs_effect_loop(effect, "Draw")) {
+        gs_draw_sprite(tex, 0, cx, cy);
+    }
+}
+
+#pragma endregion
+
 #pragma region -------------------------------------------------------------------------------------- VIDEO
 
+// the offsets are read back from the atlas, whichever path put them there they're what gets rendered
+static void meltscr_capture_start(struct meltscr_info *dwipe, uint64_t start_ns)
+{
+    struct meltscr_table *table = dwipe->_table_ptr;
+    if (!table || !meltscr_has_offsets(dwipe)) return;
+
+    struct meltscr_capture_transition record = {0};
+    record.table_type = (uint8_t)dwipe->_table_type;
+    record.steps = (uint8_t)dwipe->_steps;
+    record.motion = (uint8_t)dwipe->_motion;
+    record.slices = (uint16_t)dwipe->_slices;
+    record.offsets_size = table->offsets_size;
+    record.instance = dwipe->_capture_id;
+    record.factor = dwipe->_factor;
+    record.increment = dwipe->_increment;
+    record.dir[0] = dwipe->_dir.x;
+    record.dir[1] = dwipe->_dir.y;
+    record.uuid = table->uuid;
+    record.position = table->position;
+    record.start_ns = (uint32_t)start_ns;
+    record.timestamp_ns = os_gettime_ns();
+
+    // rows move when the atlas grows, which only happens inside the graphics context
+    uint8_t offsets[ATLAS_WIDTH];
+
+    obs_enter_graphics();
+    memcpy(offsets, table->_atlas_row >= 0 ? &atlas.shadow[(size_t)table->_atlas_row * ATLAS_WIDTH] : dwipe->_offsets, table->offsets_size);
+    obs_leave_graphics();
+
+    capture_transition(&record, offsets);
+}
+
 void meltscr_video_start(void *data)
+{
+    struct meltscr_info *dwipe = data;
+    const uint64_t start_ns = os_gettime_ns();
+
+    pthread_mutex_lock(&patterns_mutex);
+
+    dwipe->_active = true;
+
+    // a warmed up instance already has this transition's pattern uploaded
+    if (dwipe->_prebaked) dwipe->_prebaked = false;
+    else {
+        struct meltscr_table *table = dwipe->_table_ptr;
+        if (dwipe->_table_type == 2 && table && table->values_size != max_pool_size) meltscr_create_table(data);
+        meltscr_create_texture(data);
+    }
+
+    pthread_mutex_unlock(&patterns_mutex);
+
+    if (dwipe->_adaptive) meltscr_governor_start(dwipe);
+    dwipe->_render_level = dwipe->_adaptive ? dwipe->_quality_level : 0;
+
+    const uint64_t end_ns = os_gettime_ns();
+    histogram_record(&start_latency, end_ns - start_ns);
+
+    if (dwipe->_capture) meltscr_capture_start(dwipe, end_ns - start_ns);
+}
+
+void meltscr_video_stop(void *data)
 {
     struct meltscr_info *dwipe = data;
 
-    if (dwipe->_table_type == 2) meltscr_create_table(data);
-    meltscr_create_texture(data);
+    pthread_mutex_lock(&patterns_mutex);
+    dwipe->_active = false;
+    pthread_mutex_unlock(&patterns_mutex);
 }
 
+// a NULL 'b' draws the outgoing scene alone over an incoming one that's already been drawn
 static void meltscr_video_callback(void *data, gs_texture_t *a, gs_texture_t *b, float t, uint32_t cx, uint32_t cy)
 {
     struct meltscr_info *dwipe = data;
 
+    float gpu_ms = .0f;
+    const bool measured = dwipe->_gpu_pending && meltscr_gpu_poll(dwipe, &gpu_ms);
+
+    // results come a frame or more late, close enough to the current size to classify them
+    if (measured) histogram_record(&gpu_time[get_render_class(cy)], (uint64_t)(gpu_ms * 1000000.0f));
+
+    if (measured && dwipe->_adaptive) meltscr_governor_update(dwipe, gpu_ms);
+
+    const int slices = dwipe->_slices;
+
     float _factor = dwipe->_factor;
     struct vec2 factor = {_factor, 1.0f / _factor};
-    struct vec4 sizes = {(float)dwipe->_slices, (float)dwipe->_tex_resolution, 1.0f / dwipe->_slices, 1.0f / dwipe->_tex_resolution};
+    struct vec2 sizes = {(float)slices, 1.0f / slices};
 
     struct vec2 dir = dwipe->_dir;
     struct vec3 dir_mask = { fabsf(dir.x), fabsf(dir.y), lerp(dir.x, dir.y, fabsf(dir.y))};
 
     struct vec2 progress = {t, t * (1.0f + _factor)};
 
+    // libobs renders both scenes into the space being drawn to, converting each as needed, and the transition reports
+    // that same space (see meltscr_video_get_color_space), so the melt pass composes as it is with nothing left to convert
+
     const bool previous = gs_framebuffer_srgb_enabled();
     gs_enable_framebuffer_srgb(true);
 
     gs_effect_set_texture_srgb(dwipe->a_tex, a);
-    gs_effect_set_texture_srgb(dwipe->b_tex, b);
+    if (b) gs_effect_set_texture_srgb(dwipe->b_tex, b);
 
     gs_effect_set_vec2(dwipe->factor, &factor);
-    gs_effect_set_vec4(dwipe->sizes, &sizes);
+    gs_effect_set_vec2(dwipe->sizes, &sizes);
     gs_effect_set_vec2(dwipe->dir, &dir);
     gs_effect_set_vec3(dwipe->dir_mask, &dir_mask);
 
-    if (dwipe->_table_ptr) gs_effect_set_texture(dwipe->c_tex, dwipe->_table_ptr->_texture);
+    struct meltscr_table *table = dwipe->_table_ptr;
+
+    atlas_upload();
+
+    // always bound, the parameter would otherwise keep whatever the last instance drew with
+    if (table && table->_atlas_row >= 0) {
+        struct vec2 atlas_origin = {1.0f / ATLAS_WIDTH, (table->_atlas_row + .5f) / atlas.rows};
+        gs_effect_set_vec2(dwipe->atlas, &atlas_origin);
+        gs_effect_set_texture(dwipe->c_tex, atlas.texture);
+    }
+    else {
+        struct vec2 atlas_origin = {1.0f / ATLAS_WIDTH, .5f};
+        gs_effect_set_vec2(dwipe->atlas, &atlas_origin);
+        gs_effect_set_texture(dwipe->c_tex, dwipe->_offsets_texture);
+    }
 
     gs_effect_set_vec2(dwipe->progress, &progress);
 
-    while (gs_effect_loop(dwipe->effect, "MeltScreen")) {
-        gs_draw_sprite(NULL, 0, cx, cy);
+    if (dwipe->_variant & VARIANT_FADE) {
+        // dips to the colour halfway through and back out
+        struct vec4 fade_color = dwipe->_fade_color;
+        fade_color.w = dwipe->_fade_amount * cubic_ease_in_out(1.0f - fabsf(2.0f * t - 1.0f));
+        gs_effect_set_vec4(dwipe->fade_color, &fade_color);
+    }
+
+    if (dwipe->_variant & VARIANT_SHADE) {
+        // the revealed scene brightens as it's uncovered, edges show up once slices start moving
+        struct vec3 shade = {1.0f - dwipe->_shade_exposed * (1.0f - t), dwipe->_shade_edge * fminf(1.0f, t * 10.0f), 1.0f / SHADE_EDGE_WIDTH};
+        gs_effect_set_vec3(dwipe->shade, &shade);
+    }
+
+    const bool curved = dwipe->_motion && dwipe->_motion_texture;
+
+    if (curved) {
+        struct vec4 motion = {(MOTION_SAMPLES - 1.0f) / MOTION_SAMPLES, .5f / MOTION_SAMPLES, MOTION_RANGE, 1.0f / dwipe->_motion_rows};
+        gs_effect_set_vec4(dwipe->motion, &motion);
+        gs_effect_set_texture(dwipe->d_tex, dwipe->_motion_texture);
+    }
+
+    // only one query in flight, a new one starts once the previous has been read back.
+    // queries aren't free on every driver, they only run for the governor or when the stats are asked for
+    const bool timed = (dwipe->_adaptive || dwipe->_gpu_stats) && !dwipe->_gpu_pending && dwipe->_gpu_timer && dwipe->_gpu_range;
+
+    if (timed) {
+        gs_timer_range_begin(dwipe->_gpu_range);
+        gs_timer_begin(dwipe->_gpu_timer);
+    }
+
+    if (b) {
+        const bool scaled = dwipe->_render_level > 0 && meltscr_scaled_begin(dwipe, cx, cy);
+
+        while (gs_effect_loop(dwipe->effect, techniques[dwipe->_variant | (curved ? VARIANT_MOTION : 0)])) {
+            gs_draw_sprite(NULL, 0, cx, cy);
+        }
+
+        if (scaled) meltscr_scaled_end(dwipe, cx, cy);
+    }
+    else {
+        gs_blend_state_push();
+        gs_enable_blending(true);
+        gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+        while (gs_effect_loop(dwipe->effect, over_techniques[curved])) {
+            gs_draw_sprite(NULL, 0, cx, cy);
+        }
+
+        gs_blend_state_pop();
+    }
+
+    if (timed) {
+        gs_timer_end(dwipe->_gpu_timer);
+        gs_timer_range_end(dwipe->_gpu_range);
+        dwipe->_gpu_pending = true;
+    }
+
+    if (dwipe->_capture) {
+        struct meltscr_capture_frame *frame = &dwipe->_capture_frame;
+        frame->technique = (uint8_t)(dwipe->_variant | (curved ? VARIANT_MOTION : 0) | dwipe->_render_level << 5);
+        frame->slices = (uint16_t)slices;
+        frame->t = t;
+        frame->cx = cx;
+        frame->cy = cy;
+        frame->gpu_us = measured ? (uint32_t)(gpu_ms * 1000.0f) : 0u;
     }
 
     gs_enable_framebuffer_srgb(previous);
 }
 
+// B goes straight to the output, only A is rendered to a texture, saves a full frame render target and fetch
+// colour operations touch B as well so they stay on the regular path, so do sources scaled to the transition
+// and lowered levels, which render B at the melt pass resolution too
+static bool meltscr_video_render_direct(struct meltscr_info *dwipe)
+{
+    if (dwipe->_variant || dwipe->_render_level > 0) return false;
+
+    const uint32_t cx = obs_source_get_width(dwipe->source), cy = obs_source_get_height(dwipe->source);
+
+    obs_source_t *a = obs_transition_get_source(dwipe->source, OBS_TRANSITION_SOURCE_A);
+    if (!a) return false;
+
+    if (!cx || !cy || obs_source_get_width(a) != cx || obs_source_get_height(a) != cy) {
+        obs_source_release(a);
+        return false;
+    }
+
+    const float t = obs_transition_get_time(dwipe->source);
+
+    // also ends the transition once it's done, then it has drawn the scene it ended on and that's all there's to do
+    if (obs_transition_video_render_direct(dwipe->source, OBS_TRANSITION_SOURCE_B)) {
+
+        const enum gs_color_space space = gs_get_color_space();
+        const enum gs_color_format format = gs_get_format_from_space(space);
+
+        if (!dwipe->_a_render || dwipe->_a_format != format) {
+            if (dwipe->_a_render) gs_texrender_destroy(dwipe->_a_render);
+            dwipe->_a_render = gs_texrender_create(format, GS_ZS_NONE);
+            dwipe->_a_format = format;
+        }
+
+        gs_texrender_reset(dwipe->_a_render);
+
+        if (gs_texrender_begin_with_color_space(dwipe->_a_render, cx, cy, space)) {
+            struct vec4 clear;
+            vec4_zero(&clear);
+            gs_clear(GS_CLEAR_COLOR, &clear, .0f, 0);
+            gs_ortho(.0f, (float)cx, .0f, (float)cy, -100.0f, 100.0f);
+
+            obs_source_video_render(a);
+            gs_texrender_end(dwipe->_a_render);
+
+            meltscr_video_callback(dwipe, gs_texrender_get_texture(dwipe->_a_render), NULL, t, cx, cy);
+        }
+    }
+
+    obs_source_release(a);
+    return true;
+}
+
 void meltscr_video_render(void *data, gs_effect_t *effect)
 {
     struct meltscr_info *dwipe = data;
-    obs_transition_video_render(dwipe->source, meltscr_video_callback);
+    const uint64_t start_ns = os_gettime_ns();
+
+    // idle frames only draw the current scene, the direct path may end the transition on its last frame
+    const bool active = dwipe->_active;
+
+    if (active && dwipe->_adaptive) meltscr_governor_frame(dwipe);
+
+    dwipe->_capture_frame.cx = 0u;
+
+    if (!meltscr_video_render_direct(dwipe)) obs_transition_video_render(dwipe->source, meltscr_video_callback);
+
+    const uint64_t end_ns = os_gettime_ns();
+    if (active) histogram_record(&render_time, end_ns - start_ns);
+
+    // cx stays 0 when libobs drew one of the scenes directly and the callback never ran
+    if (dwipe->_capture && dwipe->_capture_frame.cx) {
+        dwipe->_capture_frame.instance = dwipe->_capture_id;
+        dwipe->_capture_frame.cpu_ns = (uint32_t)(end_ns - start_ns);
+        capture_frame(&dwipe->_capture_frame);
+    }
     UNUSED_PARAMETER(effect);
 }
 
@@ -281,7 +974,8 @@ static void meltscr_update(void *data, obs_data_t *settings)
 
         obs_data_set_int(settings, S_PRIV_TABLEUUID, (int64_t)buffer_uuid);
     }
-    else if (dwipe->_table_ptr != ctable) {
+
+    if (dwipe->_table_ptr != ctable) {
 
         if (dwipe->_table_ptr) {
             //blog(LOG_INFO, "reassigning table with uuid %" PRIu64 " at &[0x%" PRIxPTR "] (from &[0x%" PRIxPTR "])", buffer_uuid, (uintptr_t)ctable, (uintptr_t)dwipe->_table_ptr);
@@ -296,6 +990,27 @@ static void meltscr_update(void *data, obs_data_t *settings)
 
     //
 
+    dwipe->_capture = obs_data_get_bool(settings, S_PROP_CAPTURE);
+    dwipe->_gpu_stats = obs_data_get_bool(settings, S_PROP_GPUSTATS);
+
+    const bool adaptive = obs_data_get_bool(settings, S_PROP_ADAPTIVE);
+
+    if (adaptive != dwipe->_adaptive) {
+        dwipe->_adaptive = adaptive;
+        dwipe->_quality_level = 0;
+        dwipe->_gpu_samples = 0u;
+    }
+
+    // colour operations, each one only costs anything when its shader variant is used
+
+    vec4_from_rgba_srgb(&dwipe->_fade_color, (uint32_t)obs_data_get_int(settings, S_PROP_FADECOLOR));
+
+    dwipe->_fade_amount = .01f * (int)obs_data_get_int(settings, S_PROP_FADEAMOUNT);
+    dwipe->_shade_exposed = .01f * (int)obs_data_get_int(settings, S_PROP_SHADEEXPOSED);
+    dwipe->_shade_edge = .01f * (int)obs_data_get_int(settings, S_PROP_SHADEEDGE);
+
+    dwipe->_variant = (dwipe->_fade_amount > .0f ? VARIANT_FADE : 0) | (dwipe->_shade_exposed > .0f || dwipe->_shade_edge > .0f ? VARIANT_SHADE : 0);
+
     const bool use_original = obs_data_get_bool(settings, S_PROP_USEORIGINAL);
 
     if (use_original != dwipe->_use_original) {
@@ -313,12 +1028,20 @@ static void meltscr_update(void *data, obs_data_t *settings)
         dwipe->_table_type = 0;
         dwipe->_noise_resolution = 16;
         dwipe->_audio_mode = 3;
+        dwipe->_motion = 0;
 
         update_table= true;
 
     } 
     else {
 
+        const int motion = (int)obs_data_get_int(settings, S_PROP_MOTION);
+
+        if (motion != dwipe->_motion) {
+            dwipe->_motion = motion;
+            dwipe->_prebaked = false;
+        }
+
         const int dir = (int)obs_data_get_int(settings, S_PROP_DIRECTION);
 
         switch (dir) {
@@ -357,8 +1080,14 @@ static void meltscr_update(void *data, obs_data_t *settings)
 
     if (update_table) {
 
+        pthread_mutex_lock(&patterns_mutex);
+
+        dwipe->_prebaked = false;
+
         struct meltscr_table *table = dwipe->_table_ptr;
         if(table && table->state_flags & STATE_FLAG_DIRT) meltscr_create_table(data);
+
+        pthread_mutex_unlock(&patterns_mutex);
     }
 }
 
@@ -384,6 +1113,9 @@ static bool prop_changed_use_original_callback(void *data, obs_properties_t *pro
     p = obs_properties_get(props, S_PROP_DIRECTION);
     obs_property_set_enabled(p, enable_props);
 
+    p = obs_properties_get(props, S_PROP_MOTION);
+    obs_property_set_enabled(p, enable_props);
+
     p = obs_properties_get(props, S_PROP_RANDOMTYPE);
     obs_property_set_enabled(p, enable_props);
 
@@ -429,8 +1161,20 @@ static bool list_changed_table_size_callback(void *data, obs_properties_t *props
 
 static bool button_pressed_refresh_table_callback(obs_properties_t *props, obs_property_t *property, void *data)
 {
+    struct meltscr_info *dwipe = data;
+    struct meltscr_table *table = dwipe->_table_ptr;
+
+    pthread_mutex_lock(&patterns_mutex);
+
+    if (table && table->state_flags & STATE_FLAG_SHARED) {
+        obs_log(LOG_INFO, "table with uuid %" PRIu64 " is shared, regenerating it only for this session", table->uuid);
+        make_table_private(table);
+    }
+
     meltscr_create_table(data);
 
+    pthread_mutex_unlock(&patterns_mutex);
+
     UNUSED_PARAMETER(props);
     UNUSED_PARAMETER(property);
     return false;
@@ -469,6 +1213,12 @@ static obs_properties_t *meltscr_properties(void *data, void* type_data)
     obs_property_list_add_int(p, obs_module_text("Direction.Down"), 2);
     obs_property_list_add_int(p, obs_module_text("Direction.Left"), 3);
 
+    p= obs_properties_add_list(props, S_PROP_MOTION, obs_module_text("Motion"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p, obs_module_text("Motion.Linear"), 0);
+    obs_property_list_add_int(p, obs_module_text("Motion.Gravity"), 1);
+    obs_property_list_add_int(p, obs_module_text("Motion.EaseOut"), 2);
+    obs_property_list_add_int(p, obs_module_text("Motion.Bounce"), 3);
+
     p= obs_properties_add_list(props, S_PROP_RANDOMTYPE, obs_module_text("RandomMode"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
     obs_property_list_add_int(p, obs_module_text("RandomMode.Doom"), 0);
     obs_property_list_add_int(p, obs_module_text("RandomMode.Fixed"), 1);
@@ -499,6 +1249,15 @@ static obs_properties_t *meltscr_properties(void *data, void* type_data)
 
     obs_properties_add_int_slider(props, S_PROP_SWAPPOINT, obs_module_text("SwapPoint"), 1, 100, 1);
 
+    obs_properties_add_color(props, S_PROP_FADECOLOR, obs_module_text("FadeColor"));
+    obs_properties_add_int_slider(props, S_PROP_FADEAMOUNT, obs_module_text("FadeAmount"), 0, 100, 1);
+    obs_properties_add_int_slider(props, S_PROP_SHADEEXPOSED, obs_module_text("ShadeExposed"), 0, 100, 1);
+    obs_properties_add_int_slider(props, S_PROP_SHADEEDGE, obs_module_text("ShadeEdge"), 0, 100, 1);
+
+    obs_properties_add_bool(props, S_PROP_ADAPTIVE, obs_module_text("AdaptiveQuality"));
+    obs_properties_add_bool(props, S_PROP_GPUSTATS, obs_module_text("GpuStats"));
+    obs_properties_add_bool(props, S_PROP_CAPTURE, obs_module_text("CaptureLog"));
+
     //p = obs_properties_add_button(props, S_BTN_HELP, obs_module_text("Help"), NULL);
     //obs_property_button_set_type(p, OBS_BUTTON_URL);
     //obs_property_button_set_url(p, "https://sopze.com/docs?p=spz-obs-transition-meltscr");
@@ -520,17 +1279,40 @@ static const char *meltscr_get_name(void *type_data)
 void meltscr_destroy(void *data)
 {
     struct meltscr_info *dwipe = data;
+
+    pthread_mutex_lock(&instances_mutex);
+    for (struct meltscr_info **it = &instances; *it; it = &(*it)->_next) {
+        if (*it == dwipe) {
+            *it = dwipe->_next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&instances_mutex);
+
     if (dwipe->_table_ptr) leave_table(dwipe->_table_ptr);
 
+    obs_enter_graphics();
+    gs_effect_destroy(dwipe->effect);
+    if (dwipe->_motion_texture) gs_texture_destroy(dwipe->_motion_texture);
+    meltscr_drop_offsets_texture(dwipe);
+    if (dwipe->_a_render) gs_texrender_destroy(dwipe->_a_render);
+    if (dwipe->_scaled_render) gs_texrender_destroy(dwipe->_scaled_render);
+    if (dwipe->_gpu_timer) gs_timer_destroy(dwipe->_gpu_timer);
+    if (dwipe->_gpu_range) gs_timer_range_destroy(dwipe->_gpu_range);
+    obs_leave_graphics();
+
+    bfree(dwipe->_motion_data);
     bfree(dwipe);
 }
 
 static enum gs_color_space meltscr_video_get_color_space(void *data, size_t count, const enum gs_color_space *preferred_spaces)
 {
-    UNUSED_PARAMETER(count);
-    UNUSED_PARAMETER(preferred_spaces);
-
     struct meltscr_info *const dwipe = data;
+
+    // a single preferred space is the one being rendered to. libobs has already rendered both scenes into it,
+    // so composing them there leaves nothing for a conversion pass around the transition to do
+    if (count == 1) return preferred_spaces[0];
+
     return obs_transition_video_get_color_space(dwipe->source);
 }
 
@@ -542,6 +1324,7 @@ struct obs_source_info meltscr_transition = {
     .destroy = meltscr_destroy,
     .update = meltscr_update,
     .transition_start = meltscr_video_start,
+    .transition_stop = meltscr_video_stop,
     .video_render = meltscr_video_render,
     .audio_render = meltscr_audio_render,
     .get_properties2 = meltscr_properties,
@@ -0,0 +1,361 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// runs thousands of back-to-back transitions over hundreds of instances with mixed settings in the stand-in libobs,
+// then reports start latency, frame render time and what the plugin's memory did meanwhile.
+// anything still growing once every instance has gone through a few rounds is a leak
+// usage: meltscr-soak <data dir> <config dir> [instances] [transitions] [frames]
+
+#include "stand-in.h"
+#include "plugin-common.h"
+
+#include <stdlib.h>
+
+bool obs_module_load(void);
+void obs_module_unload(void);
+
+#define MAX_INSTANCES 1000
+#define WARM_UP_ROUNDS 2
+
+// 1 in CHURN_RATE transitions changes an instance's settings, as many recreate one from its saved settings
+#define CHURN_RATE 16
+
+struct soak_instance {
+    obs_source_t *source;
+    obs_data_t *settings;
+    uint32_t cx, cy;
+};
+
+// what the plugin holds between transitions, no instance playing
+struct soak_sample {
+    long allocs;
+    size_t bytes;
+    long graphics_objects;
+    uint16_t tables;
+    size_t pool_bytes; // table values, Dynamic pools grow into theirs a chunk at a time
+    long other_allocs; // everything but tables, their values and shared buffers
+    size_t other_bytes;
+};
+
+// log2 buckets of bytes, bucket 0 holds transitions that left the plugin holding no more than before
+struct soak_growth {
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    size_t max;
+};
+
+static struct soak_instance instances[MAX_INSTANCES];
+
+static uint32_t rng_state = 0x9E3779B9u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int rng_range(int min, int max)
+{
+    return min + (int)(rng() % (uint32_t)(max - min + 1));
+}
+
+static void randomize_settings(obs_data_t *settings)
+{
+    static const int table_sizes[] = {-1, 8, 16, 32, 64};
+
+    obs_data_set_bool(settings, "use_original", rng() % 8u == 0u);
+    obs_data_set_int(settings, "random_type", rng() % 3u);
+    obs_data_set_int(settings, "table_size", table_sizes[rng() % 5u]);
+    obs_data_set_int(settings, "slices", rng_range((int)min_slices, 400));
+    obs_data_set_int(settings, "factor", rng_range(1, 100));
+    obs_data_set_int(settings, "steps", rng_range((int)min_steps, (int)max_steps));
+    obs_data_set_int(settings, "increment", rng_range(1, 100));
+    obs_data_set_int(settings, "direction", rng() % 4u);
+    obs_data_set_int(settings, "motion", rng() % 4u);
+    obs_data_set_int(settings, "fade_amount", rng() % 2u ? rng_range(0, 100) : 0);
+    obs_data_set_int(settings, "shade_exposed", rng() % 4u ? 0 : rng_range(0, 100));
+    obs_data_set_int(settings, "shade_edge", rng() % 4u ? 0 : rng_range(0, 100));
+    obs_data_set_bool(settings, "adaptive_quality", rng() % 4u == 0u);
+}
+
+static bool create_instance(struct soak_instance *instance)
+{
+    static const uint32_t sizes[][2] = {{1280u, 720u}, {1920u, 1080u}, {3840u, 2160u}};
+
+    if (!instance->settings) {
+        const uint32_t *size = sizes[rng() % 3u];
+        instance->cx = size[0];
+        instance->cy = size[1];
+
+        instance->settings = obs_data_create();
+        randomize_settings(instance->settings);
+    }
+
+    // the settings keep the table uuid, a recreated instance picks its table back up like a reloaded scene collection does
+    instance->source = stand_in_create_transition("meltscr_transition", "soak", instance->settings, instance->cx, instance->cy);
+    return instance->source != NULL;
+}
+
+// the one the plugin wrote back into the instance's settings
+static struct meltscr_table *instance_table(const struct soak_instance *instance)
+{
+    return get_table_by_uuid((uint64_t)obs_data_get_int(instance->settings, "uuid"));
+}
+
+static void play(obs_source_t *source, int frames)
+{
+    stand_in_start(source);
+    for (int i = 1; i <= frames; i++) stand_in_render(source, (float)i / frames);
+}
+
+// tables are counted the way report_stats does, the settings churn moves them between modes that hold their values differently
+static struct soak_sample take_sample(void)
+{
+    struct soak_sample sample = {bnum_allocs(), stand_in_allocated_bytes(), stand_in_graphics_objects(), table_count};
+
+    long table_allocs = 0;
+    size_t table_bytes = 0u;
+
+    for (uint16_t i = 0u; i < table_count; i++) {
+        if (!tables[i]) continue;
+
+        sample.pool_bytes += tables[i]->values_capacity;
+        table_bytes += sizeof(struct meltscr_table) + tables[i]->values_capacity;
+        table_allocs += tables[i]->values_capacity ? 2 : 1;
+    }
+
+    for (uint32_t i = 0u; i < buffer_count; i++) table_bytes += sizeof(struct meltscr_buffer) + buffers[i]->size;
+    table_allocs += 2 * (long)buffer_count;
+
+    // the buffer list is left at its largest when buffers go away, its bytes stay with the others
+    if (buffers) table_allocs++;
+
+    sample.other_allocs = sample.allocs - table_allocs;
+    sample.other_bytes = sample.bytes - table_bytes;
+    return sample;
+}
+
+// with no instance alive, whatever a transition leaked is all that's left besides the tables
+static struct soak_sample settle(int count)
+{
+    for (int i = 0; i < count; i++) stand_in_destroy(instances[i].source);
+
+    const struct soak_sample sample = take_sample();
+
+    for (int i = 0; i < count; i++) {
+        if (!create_instance(&instances[i])) {
+            fprintf(stderr, "instance %d failed to recreate\n", i);
+            exit(1);
+        }
+    }
+    return sample;
+}
+
+static void growth_record(struct soak_growth *g, size_t before, size_t after)
+{
+    const size_t bytes = after > before ? after - before : 0u;
+
+    int bucket = 0;
+    for (size_t b = bytes; b > 1u && bucket < HISTOGRAM_BUCKETS - 1; b >>= 1) bucket++;
+
+    g->buckets[bytes ? bucket : 0]++;
+    g->count++;
+    if (bytes > g->max) g->max = bytes;
+}
+
+static void growth_report(const struct soak_growth *g, const char *name)
+{
+    printf("%s: %" PRIu64 " transitions, max %zu bytes\n", name, g->count, g->max);
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (!g->buckets[i]) continue;
+        if (i == 0) printf("  none/<2B    %" PRIu64 "\n", g->buckets[i]);
+        else printf("  <%-10" PRIu64 " %" PRIu64 "\n", (uint64_t)2u << i, g->buckets[i]);
+    }
+}
+
+static void histogram_print(const struct meltscr_histogram *h, const char *name)
+{
+    if (!h->count) return;
+
+    printf("%s: %" PRIu64 " samples, avg %.1fus, p50 <%" PRIu64 "us, p99 <%" PRIu64 "us, max %.1fus\n", name, h->count,
+           h->total_ns / 1000.0 / h->count, histogram_percentile(h, .5), histogram_percentile(h, .99), h->max_ns / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <data dir> <config dir> [instances] [transitions] [frames]\n", argv[0]);
+        return 2;
+    }
+
+    const int count = argc > 3 ? atoi(argv[3]) : 200;
+    const int transitions = argc > 4 ? atoi(argv[4]) : 5000;
+    const int frames = argc > 5 ? atoi(argv[5]) : 8;
+
+    if (count < 1 || count > MAX_INSTANCES || transitions < count * (WARM_UP_ROUNDS + 2) || frames < 1) {
+        fprintf(stderr, "1 to %d instances, at least %d transitions per instance and a frame at least\n", MAX_INSTANCES, WARM_UP_ROUNDS + 2);
+        return 2;
+    }
+
+    stand_in_init(argv[2], argv[1]);
+
+    int failures = 0;
+
+    if (!obs_module_load()) {
+        fprintf(stderr, "the plugin failed to load\n");
+        return 1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (!create_instance(&instances[i])) {
+            fprintf(stderr, "instance %d failed to create\n", i);
+            return 1;
+        }
+
+        // only an instance holding a table can build a pattern ahead of time
+        calldata_t cd = {0};
+        if (!proc_handler_call(obs_source_get_proc_handler(instances[i].source), "warm_up", &cd) || !calldata_bool(&cd, "ready")) {
+            fprintf(stderr, "instance %d can't build a pattern once created\n", i);
+            return 1;
+        }
+    }
+
+    uint32_t errors = 0u, unlocked_calls = 0u, patternless = 0u;
+    struct soak_sample baseline = {0}, peak = {0};
+    struct soak_growth growth = {0};
+
+    const int warm_up = count * WARM_UP_ROUNDS;
+    const int measured = transitions - warm_up;
+
+    for (int n = 0; n < transitions; n++) {
+
+        // the measured part starts with every instance, and the settings churn, having been through a couple of rounds
+        if (n == warm_up) {
+            // timings are only worth anything if every instance draws its own pattern
+            for (int i = 0; i < count; i++) {
+                const struct meltscr_table *table = instance_table(&instances[i]);
+
+                if (!table || !table->users || table->_atlas_row < 0) {
+                    fprintf(stderr, "instance %d has %s after warm-up\n", i, !table || !table->users ? "no table" : "no atlas row");
+                    return 1;
+                }
+
+                for (int j = 0; j < i; j++) {
+                    if (instance_table(&instances[j]) != table) continue;
+                    fprintf(stderr, "instances %d and %d share table with uuid %" PRIu64 "\n", j, i, table->uuid);
+                    return 1;
+                }
+            }
+
+            memset(&start_latency, 0, sizeof(start_latency));
+            memset(&render_time, 0, sizeof(render_time));
+            baseline = settle(count);
+        }
+
+        if (n % CHURN_RATE == 0) {
+            struct soak_instance *instance = &instances[rng() % (uint32_t)count];
+            randomize_settings(instance->settings);
+            obs_source_update(instance->source, NULL);
+
+            instance = &instances[rng() % (uint32_t)count];
+            stand_in_destroy(instance->source);
+            if (!create_instance(instance)) {
+                fprintf(stderr, "instance failed to recreate\n");
+                return 1;
+            }
+        }
+
+        const size_t before = stand_in_allocated_bytes();
+
+        stand_in_reset_recording();
+        play(instances[n % count].source, frames);
+        errors += stand_in_recording.errors;
+        unlocked_calls += stand_in_recording.unlocked_calls;
+
+        if (n < warm_up) continue;
+
+        const struct meltscr_table *table = instance_table(&instances[n % count]);
+        if (!table || table->_atlas_row < 0) patternless++;
+
+        growth_record(&growth, before, stand_in_allocated_bytes());
+
+        const struct soak_sample sample = take_sample();
+        if (sample.allocs > peak.allocs) peak.allocs = sample.allocs;
+        if (sample.bytes > peak.bytes) peak.bytes = sample.bytes;
+        if (sample.graphics_objects > peak.graphics_objects) peak.graphics_objects = sample.graphics_objects;
+        if (sample.tables > peak.tables) peak.tables = sample.tables;
+        if (sample.pool_bytes > peak.pool_bytes) peak.pool_bytes = sample.pool_bytes;
+    }
+
+    const struct soak_sample last = settle(count);
+
+    printf("%d instance(s), %d transition(s) of %d frame(s), %d measured\n", count, transitions, frames, measured);
+    histogram_print(&start_latency, "transition start");
+    histogram_print(&render_time, "frame render");
+    growth_report(&growth, "allocation growth per transition");
+
+    printf("%-16s %12s %12s %12s %12s %8s %12s %12s\n", "", "allocations", "bytes", "gpu objects", "pool bytes", "tables", "other allocs", "other bytes");
+    printf("%-16s %12ld %12zu %12ld %12zu %8u %12ld %12zu\n", "after warm-up", baseline.allocs, baseline.bytes, baseline.graphics_objects,
+           baseline.pool_bytes, baseline.tables, baseline.other_allocs, baseline.other_bytes);
+    printf("%-16s %12ld %12zu %12ld %12zu %8u\n", "peak, playing", peak.allocs, peak.bytes, peak.graphics_objects, peak.pool_bytes, peak.tables);
+    printf("%-16s %12ld %12zu %12ld %12zu %8u %12ld %12zu\n", "end", last.allocs, last.bytes, last.graphics_objects, last.pool_bytes, last.tables,
+           last.other_allocs, last.other_bytes);
+
+    // the same instances come back from the same settings, they find their tables and nothing else should have stayed.
+    // there are never more buffers than tables, however large their list got meanwhile
+    const size_t buffer_list_slack = sizeof(struct meltscr_buffer *) * baseline.tables;
+
+    if (last.other_allocs != baseline.other_allocs || last.other_bytes > baseline.other_bytes + buffer_list_slack) {
+        fprintf(stderr, "%ld allocation(s), %lld bytes more than after warm-up\n", last.other_allocs - baseline.other_allocs,
+                (long long)last.other_bytes - (long long)baseline.other_bytes);
+        failures++;
+    }
+    if (last.graphics_objects != baseline.graphics_objects) {
+        fprintf(stderr, "%ld graphics object(s) more than after warm-up\n", last.graphics_objects - baseline.graphics_objects);
+        failures++;
+    }
+    if (peak.tables > baseline.tables || last.tables > baseline.tables) {
+        fprintf(stderr, "tables kept growing: %u, %u after warm-up\n", peak.tables > last.tables ? peak.tables : last.tables, baseline.tables);
+        failures++;
+    }
+
+    // table values are bounded too, a Dynamic pool stops at the largest one there is
+    if (peak.pool_bytes > (size_t)baseline.tables * max_pool_size) {
+        fprintf(stderr, "table values held %zu bytes, over %u pools\n", peak.pool_bytes, baseline.tables);
+        failures++;
+    }
+    if (patternless) {
+        fprintf(stderr, "%u transition(s) played without a pattern\n", patternless);
+        failures++;
+    }
+    if (errors || unlocked_calls) {
+        fprintf(stderr, "%u error(s) logged, %u graphics call(s) without the graphics context\n", errors, unlocked_calls);
+        failures++;
+    }
+
+    for (int i = 0; i < count; i++) {
+        stand_in_destroy(instances[i].source);
+        obs_data_release(instances[i].settings);
+    }
+
+    obs_module_unload();
+
+    if (stand_in_graphics_objects() != 0) {
+        fprintf(stderr, "%ld graphics object(s) outlived the plugin\n", stand_in_graphics_objects());
+        failures++;
+    }
+
+    stand_in_shutdown();
+
+    if (bnum_allocs() != 0) {
+        fprintf(stderr, "%ld allocation(s) outlived the plugin\n", bnum_allocs());
+        failures++;
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,10 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// stand-in for libobs' graphics/vec2.h, struct vec2 lives in obs-module.h
+
+#pragma once
+
+#include <obs-module.h>
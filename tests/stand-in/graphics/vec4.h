@@ -0,0 +1,36 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// stand-in for libobs' graphics/vec4.h, same conversions
+
+#pragma once
+
+#include <obs-module.h>
+
+static inline void vec4_zero(struct vec4 *dst)
+{
+    dst->x = dst->y = dst->z = dst->w = .0f;
+}
+
+static inline void vec4_from_rgba(struct vec4 *dst, uint32_t rgba)
+{
+    dst->x = (float)(rgba & 0xFF) / 255.0f;
+    dst->y = (float)((rgba >> 8) & 0xFF) / 255.0f;
+    dst->z = (float)((rgba >> 16) & 0xFF) / 255.0f;
+    dst->w = (float)((rgba >> 24) & 0xFF) / 255.0f;
+}
+
+static inline float gs_srgb_nonlinear_to_linear(float u)
+{
+    return (u <= 0.04045f) ? (u / 12.92f) : powf((u + 0.055f) / 1.055f, 2.4f);
+}
+
+static inline void vec4_from_rgba_srgb(struct vec4 *dst, uint32_t rgba)
+{
+    vec4_from_rgba(dst, rgba);
+    dst->x = gs_srgb_nonlinear_to_linear(dst->x);
+    dst->y = gs_srgb_nonlinear_to_linear(dst->y);
+    dst->z = gs_srgb_nonlinear_to_linear(dst->z);
+}
@@ -0,0 +1,238 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// stand-in for the parts of libobs the plugin uses, enough to create, update and render it headless.
+// declarations follow libobs' own, stand-in.h has what tests use to drive and inspect it
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#define EXPORT
+#define MODULE_EXPORT
+#define UNUSED_PARAMETER(param) (void)param
+
+#define LOG_ERROR 100
+#define LOG_WARNING 200
+#define LOG_INFO 300
+#define LOG_DEBUG 400
+
+// the stand-in is the module's host, there's no module pointer or locale lookup to declare
+#define OBS_DECLARE_MODULE()
+#define OBS_MODULE_USE_DEFAULT_LOCALE(module_name, default_locale)
+
+#pragma region -------------------------------------------------------------------------------------- TYPES
+
+typedef struct obs_source obs_source_t;
+typedef struct obs_data obs_data_t;
+typedef struct obs_properties obs_properties_t;
+typedef struct obs_property obs_property_t;
+typedef struct proc_handler proc_handler_t;
+typedef struct calldata calldata_t;
+typedef struct video_output video_t;
+
+typedef struct gs_effect gs_effect_t;
+typedef struct gs_effect_param gs_eparam_t;
+typedef struct gs_texture gs_texture_t;
+typedef struct gs_texture_render gs_texrender_t;
+typedef struct gs_timer gs_timer_t;
+typedef struct gs_timer_range gs_timer_range_t;
+
+enum gs_color_format { GS_UNKNOWN, GS_A8, GS_R8, GS_RGBA, GS_BGRX, GS_BGRA, GS_R10G10B10A2, GS_RGBA16, GS_R16, GS_RGBA16F, GS_RGBA32F };
+enum gs_zstencil_format { GS_ZS_NONE };
+enum gs_color_space { GS_CS_SRGB, GS_CS_SRGB_16F, GS_CS_709_EXTENDED, GS_CS_709_SCRGB };
+enum gs_blend_type { GS_BLEND_ZERO, GS_BLEND_ONE, GS_BLEND_SRCCOLOR, GS_BLEND_INVSRCCOLOR, GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA };
+
+#define GS_DYNAMIC (1 << 1)
+#define GS_CLEAR_COLOR (1 << 0)
+
+enum obs_source_type { OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_TYPE_FILTER, OBS_SOURCE_TYPE_TRANSITION, OBS_SOURCE_TYPE_SCENE };
+enum obs_transition_target { OBS_TRANSITION_SOURCE_A, OBS_TRANSITION_SOURCE_B };
+enum obs_base_effect { OBS_EFFECT_DEFAULT };
+
+enum obs_property_type { OBS_PROPERTY_INVALID, OBS_PROPERTY_BOOL, OBS_PROPERTY_INT, OBS_PROPERTY_LIST, OBS_PROPERTY_COLOR, OBS_PROPERTY_BUTTON, OBS_PROPERTY_GROUP, OBS_PROPERTY_COLOR_ALPHA };
+enum obs_combo_type { OBS_COMBO_TYPE_INVALID, OBS_COMBO_TYPE_EDITABLE, OBS_COMBO_TYPE_LIST };
+enum obs_combo_format { OBS_COMBO_FORMAT_INVALID, OBS_COMBO_FORMAT_INT, OBS_COMBO_FORMAT_FLOAT, OBS_COMBO_FORMAT_STRING };
+enum obs_group_type { OBS_COMBO_INVALID, OBS_GROUP_NORMAL, OBS_GROUP_CHECKABLE };
+
+struct vec2 { float x, y; };
+struct vec3 { float x, y, z, w; };
+struct vec4 { float x, y, z, w; };
+
+struct obs_video_info {
+    const char *graphics_module;
+    uint32_t fps_num;
+    uint32_t fps_den;
+    uint32_t base_width;
+    uint32_t base_height;
+    uint32_t output_width;
+    uint32_t output_height;
+};
+
+struct obs_source_audio_mix;
+
+typedef void (*obs_transition_video_render_callback_t)(void *data, gs_texture_t *a, gs_texture_t *b, float t, uint32_t cx, uint32_t cy);
+typedef float (*obs_transition_audio_mix_callback_t)(void *data, float t);
+typedef void (*proc_handler_proc_t)(void *data, calldata_t *cd);
+typedef bool (*obs_property_modified2_t)(void *priv, obs_properties_t *props, obs_property_t *property, obs_data_t *settings);
+typedef bool (*obs_property_clicked_t)(obs_properties_t *props, obs_property_t *property, void *data);
+
+struct obs_source_info {
+    const char *id;
+    enum obs_source_type type;
+    uint32_t output_flags;
+    const char *(*get_name)(void *type_data);
+    void *(*create)(obs_data_t *settings, obs_source_t *source);
+    void (*destroy)(void *data);
+    void (*get_defaults)(obs_data_t *settings);
+    void (*update)(void *data, obs_data_t *settings);
+    void (*video_render)(void *data, gs_effect_t *effect);
+    bool (*audio_render)(void *data, uint64_t *ts_out, struct obs_source_audio_mix *audio_output, uint32_t mixers, size_t channels, size_t sample_rate);
+    void (*transition_start)(void *data);
+    void (*transition_stop)(void *data);
+    obs_properties_t *(*get_properties2)(void *data, void *type_data);
+    enum gs_color_space (*video_get_color_space)(void *data, size_t count, const enum gs_color_space *preferred_spaces);
+};
+
+// fixed capacity, the plugin never passes more than a couple of values
+struct calldata {
+    struct {
+        char name[32];
+        long long value;
+    } items[8];
+    size_t count;
+};
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- FUNCTIONS
+
+void *bmalloc(size_t size);
+void *bzalloc(size_t size);
+void *brealloc(void *ptr, size_t size);
+void bfree(void *ptr);
+char *bstrdup(const char *str);
+long bnum_allocs(void);
+
+void blog(int log_level, const char *format, ...);
+
+char *obs_module_config_path(const char *file);
+char *obs_module_file(const char *file);
+const char *obs_module_text(const char *lookup_string);
+
+void obs_register_source(struct obs_source_info *info);
+
+bool obs_get_video_info(struct obs_video_info *ovi);
+float obs_get_video_sdr_white_level(void);
+uint32_t obs_get_lagged_frames(void);
+video_t *obs_get_video(void);
+uint32_t video_output_get_skipped_frames(const video_t *video);
+gs_effect_t *obs_get_base_effect(enum obs_base_effect effect);
+proc_handler_t *obs_get_proc_handler(void);
+
+void obs_enter_graphics(void);
+void obs_leave_graphics(void);
+
+obs_data_t *obs_data_create(void);
+void obs_data_release(obs_data_t *data);
+void obs_data_set_default_int(obs_data_t *data, const char *name, long long val);
+void obs_data_set_default_bool(obs_data_t *data, const char *name, bool val);
+void obs_data_set_int(obs_data_t *data, const char *name, long long val);
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val);
+long long obs_data_get_int(obs_data_t *data, const char *name);
+bool obs_data_get_bool(obs_data_t *data, const char *name);
+
+const char *obs_source_get_name(const obs_source_t *source);
+uint32_t obs_source_get_width(obs_source_t *source);
+uint32_t obs_source_get_height(obs_source_t *source);
+void obs_source_update(obs_source_t *source, obs_data_t *settings);
+void obs_source_video_render(obs_source_t *source);
+void obs_source_release(obs_source_t *source);
+proc_handler_t *obs_source_get_proc_handler(const obs_source_t *source);
+
+obs_source_t *obs_transition_get_source(obs_source_t *transition, enum obs_transition_target target);
+float obs_transition_get_time(obs_source_t *transition);
+void obs_transition_video_render(obs_source_t *transition, obs_transition_video_render_callback_t callback);
+bool obs_transition_video_render_direct(obs_source_t *transition, enum obs_transition_target target);
+enum gs_color_space obs_transition_video_get_color_space(obs_source_t *transition);
+bool obs_transition_audio_render(obs_source_t *transition, uint64_t *ts_out, struct obs_source_audio_mix *audio, uint32_t mixers, size_t channels,
+                                 size_t sample_rate, obs_transition_audio_mix_callback_t mix_a, obs_transition_audio_mix_callback_t mix_b);
+
+obs_properties_t *obs_properties_create(void);
+void obs_properties_destroy(obs_properties_t *props);
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *property);
+obs_property_t *obs_properties_add_bool(obs_properties_t *props, const char *name, const char *description);
+obs_property_t *obs_properties_add_int_slider(obs_properties_t *props, const char *name, const char *description, int min, int max, int step);
+obs_property_t *obs_properties_add_list(obs_properties_t *props, const char *name, const char *description, enum obs_combo_type type,
+                                        enum obs_combo_format format);
+obs_property_t *obs_properties_add_color(obs_properties_t *props, const char *name, const char *description);
+obs_property_t *obs_properties_add_button2(obs_properties_t *props, const char *name, const char *text, obs_property_clicked_t callback, void *priv);
+obs_property_t *obs_properties_add_group(obs_properties_t *props, const char *name, const char *description, enum obs_group_type type,
+                                         obs_properties_t *group);
+size_t obs_property_list_add_int(obs_property_t *p, const char *name, long long val);
+void obs_property_set_modified_callback2(obs_property_t *p, obs_property_modified2_t modified, void *priv);
+void obs_property_set_enabled(obs_property_t *p, bool enabled);
+void obs_property_set_visible(obs_property_t *p, bool visible);
+
+void proc_handler_add(proc_handler_t *handler, const char *decl_string, proc_handler_proc_t proc, void *data);
+bool proc_handler_call(proc_handler_t *handler, const char *name, calldata_t *params);
+
+void calldata_set_int(calldata_t *data, const char *name, long long val);
+void calldata_set_bool(calldata_t *data, const char *name, bool val);
+long long calldata_int(const calldata_t *data, const char *name);
+bool calldata_bool(const calldata_t *data, const char *name);
+
+gs_effect_t *gs_effect_create_from_file(const char *file, char **error_string);
+void gs_effect_destroy(gs_effect_t *effect);
+gs_eparam_t *gs_effect_get_param_by_name(const gs_effect_t *effect, const char *name);
+bool gs_effect_loop(gs_effect_t *effect, const char *name);
+void gs_effect_set_bool(gs_eparam_t *param, bool val);
+void gs_effect_set_float(gs_eparam_t *param, float val);
+void gs_effect_set_vec2(gs_eparam_t *param, const struct vec2 *val);
+void gs_effect_set_vec3(gs_eparam_t *param, const struct vec3 *val);
+void gs_effect_set_vec4(gs_eparam_t *param, const struct vec4 *val);
+void gs_effect_set_texture(gs_eparam_t *param, gs_texture_t *val);
+void gs_effect_set_texture_srgb(gs_eparam_t *param, gs_texture_t *val);
+
+gs_texture_t *gs_texture_create(uint32_t width, uint32_t height, enum gs_color_format color_format, uint32_t levels, const uint8_t **data, uint32_t flags);
+void gs_texture_destroy(gs_texture_t *tex);
+void gs_texture_set_image(gs_texture_t *tex, const uint8_t *data, uint32_t linesize, bool invert);
+void gs_copy_texture_region(gs_texture_t *dst, uint32_t dst_x, uint32_t dst_y, gs_texture_t *src, uint32_t src_x, uint32_t src_y, uint32_t src_w, uint32_t src_h);
+
+gs_texrender_t *gs_texrender_create(enum gs_color_format format, enum gs_zstencil_format zsformat);
+void gs_texrender_destroy(gs_texrender_t *texrender);
+void gs_texrender_reset(gs_texrender_t *texrender);
+bool gs_texrender_begin_with_color_space(gs_texrender_t *texrender, uint32_t cx, uint32_t cy, enum gs_color_space space);
+void gs_texrender_end(gs_texrender_t *texrender);
+gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender);
+
+gs_timer_t *gs_timer_create(void);
+void gs_timer_destroy(gs_timer_t *timer);
+void gs_timer_begin(gs_timer_t *timer);
+void gs_timer_end(gs_timer_t *timer);
+bool gs_timer_get_data(gs_timer_t *timer, uint64_t *ticks);
+gs_timer_range_t *gs_timer_range_create(void);
+void gs_timer_range_destroy(gs_timer_range_t *range);
+void gs_timer_range_begin(gs_timer_range_t *range);
+void gs_timer_range_end(gs_timer_range_t *range);
+bool gs_timer_range_get_data(gs_timer_range_t *range, bool *disjoint, uint64_t *frequency);
+
+void gs_draw_sprite(gs_texture_t *tex, uint32_t flip, uint32_t width, uint32_t height);
+void gs_clear(uint32_t clear_flags, const struct vec4 *color, float depth, uint8_t stencil);
+void gs_ortho(float left, float right, float top, float bottom, float znear, float zfar);
+void gs_blend_state_push(void);
+void gs_blend_state_pop(void);
+void gs_enable_blending(bool enable);
+void gs_blend_function(enum gs_blend_type src, enum gs_blend_type dest);
+bool gs_framebuffer_srgb_enabled(void);
+void gs_enable_framebuffer_srgb(bool enable);
+enum gs_color_space gs_get_color_space(void);
+enum gs_color_format gs_get_format_from_space(enum gs_color_space space);
+
+#pragma endregion
@@ -0,0 +1,1474 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// stand-in libobs: memory, logging, settings, sources and transitions behave like libobs' own,
+// the graphics subsystem records what it's asked to do instead of doing it
+
+#include "stand-in.h"
+
+#include <util/platform.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define MAX_ITEMS 64
+#define MAX_NAMES 64
+#define MAX_PROCS 16
+#define MAX_TYPES 4
+#define MAX_TARGETS 8
+#define MAX_BLEND_STATES 8
+
+struct stand_in_recording stand_in_recording;
+struct stand_in_config stand_in_config = {.5f, GS_CS_SRGB, GS_CS_SRGB, false};
+
+static char config_dir[512];
+static char data_dir[512];
+
+static long allocs = 0;
+static long graphics_objects = 0;
+static int graphics_depth = 0;
+
+#pragma region -------------------------------------------------------------------------------------- MEMORY & LOGGING
+
+// every block carries its size in front of it, for the byte count
+#define BLOCK_HEADER 16u
+
+static size_t allocated_bytes = 0u;
+
+void *bmalloc(size_t size)
+{
+    uint8_t *block = malloc(size + BLOCK_HEADER);
+    if (!block) abort();
+
+    *(size_t *)block = size;
+    allocs++;
+    allocated_bytes += size;
+    return block + BLOCK_HEADER;
+}
+
+void *bzalloc(size_t size)
+{
+    void *ptr = bmalloc(size);
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void *brealloc(void *ptr, size_t size)
+{
+    if (!ptr) return bmalloc(size);
+
+    uint8_t *block = (uint8_t *)ptr - BLOCK_HEADER;
+    const size_t previous = *(size_t *)block;
+
+    block = realloc(block, size + BLOCK_HEADER);
+    if (!block) abort();
+
+    *(size_t *)block = size;
+    allocated_bytes += size;
+    allocated_bytes -= previous;
+    return block + BLOCK_HEADER;
+}
+
+void bfree(void *ptr)
+{
+    if (!ptr) return;
+
+    uint8_t *block = (uint8_t *)ptr - BLOCK_HEADER;
+    allocs--;
+    allocated_bytes -= *(size_t *)block;
+    free(block);
+}
+
+char *bstrdup(const char *str)
+{
+    if (!str) return NULL;
+
+    const size_t size = strlen(str) + 1u;
+    char *dup = bmalloc(size);
+    memcpy(dup, str, size);
+    return dup;
+}
+
+long bnum_allocs(void)
+{
+    return allocs;
+}
+
+void blogva(int log_level, const char *format, va_list args)
+{
+    if (log_level <= LOG_ERROR) stand_in_recording.errors++;
+    else if (log_level <= LOG_WARNING) stand_in_recording.warnings++;
+
+    if (stand_in_config.verbose || log_level <= LOG_WARNING) {
+        fprintf(stderr, "%s ", log_level <= LOG_ERROR ? "error:" : log_level <= LOG_WARNING ? "warning:" : "info:");
+        vfprintf(stderr, format, args);
+        fputc('\n', stderr);
+    }
+}
+
+void blog(int log_level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    blogva(log_level, format, args);
+    va_end(args);
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- PLATFORM
+
+FILE *os_fopen(const char *path, const char *mode)
+{
+    return path ? fopen(path, mode) : NULL;
+}
+
+int64_t os_ftelli64(FILE *file)
+{
+    return (int64_t)ftello(file);
+}
+
+int os_mkdirs(const char *path)
+{
+    char partial[512];
+    snprintf(partial, sizeof(partial), "%s", path);
+
+    for (char *c = partial + 1; *c; c++) {
+        if (*c != '/') continue;
+        *c = '\0';
+        mkdir(partial, 0755);
+        *c = '/';
+    }
+
+    return mkdir(partial, 0755) == 0 || errno == EEXIST ? 0 : -1;
+}
+
+int os_rename(const char *old_path, const char *new_path)
+{
+    return rename(old_path, new_path);
+}
+
+int os_unlink(const char *path)
+{
+    return remove(path);
+}
+
+uint64_t os_gettime_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+size_t os_utf8_to_wcs_ptr(const char *str, size_t len, wchar_t **pstr)
+{
+    UNUSED_PARAMETER(str);
+    UNUSED_PARAMETER(len);
+    *pstr = NULL;
+    return 0u;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- MODULE
+
+static const struct obs_source_info *types[MAX_TYPES];
+static size_t type_count = 0u;
+
+static char *join_path(const char *dir, const char *file)
+{
+    if (!file) return bstrdup(dir);
+
+    char *path = bmalloc(strlen(dir) + strlen(file) + 2u);
+    sprintf(path, "%s/%s", dir, file);
+    return path;
+}
+
+char *obs_module_config_path(const char *file)
+{
+    return join_path(config_dir, file);
+}
+
+char *obs_module_file(const char *file)
+{
+    return join_path(data_dir, file);
+}
+
+const char *obs_module_text(const char *lookup_string)
+{
+    return lookup_string;
+}
+
+void obs_register_source(struct obs_source_info *info)
+{
+    if (type_count < MAX_TYPES) types[type_count++] = info;
+}
+
+bool obs_get_video_info(struct obs_video_info *ovi)
+{
+    memset(ovi, 0, sizeof(*ovi));
+    ovi->graphics_module = "stand-in";
+    ovi->fps_num = 60u;
+    ovi->fps_den = 1u;
+    ovi->base_width = ovi->output_width = 1920u;
+    ovi->base_height = ovi->output_height = 1080u;
+    return true;
+}
+
+float obs_get_video_sdr_white_level(void)
+{
+    return 300.0f;
+}
+
+uint32_t obs_get_lagged_frames(void)
+{
+    return stand_in_config.lagged_frames;
+}
+
+// a single output, only there to count skipped frames
+struct video_output {
+    int unused;
+};
+
+static video_t video_output;
+
+video_t *obs_get_video(void)
+{
+    return &video_output;
+}
+
+uint32_t video_output_get_skipped_frames(const video_t *video)
+{
+    UNUSED_PARAMETER(video);
+    return stand_in_config.skipped_frames;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- SETTINGS
+
+struct obs_data_item {
+    char name[MAX_NAMES];
+    long long value;
+    long long default_value;
+    bool has_value;
+    bool has_default;
+};
+
+struct obs_data {
+    struct obs_data_item items[MAX_ITEMS];
+    size_t count;
+    long refs;
+};
+
+static struct obs_data_item *get_item(obs_data_t *data, const char *name, bool create)
+{
+    for (size_t i = 0u; i < data->count; i++) {
+        if (!strcmp(data->items[i].name, name)) return &data->items[i];
+    }
+
+    if (!create || data->count == MAX_ITEMS) return NULL;
+
+    struct obs_data_item *item = &data->items[data->count++];
+    memset(item, 0, sizeof(*item));
+    snprintf(item->name, sizeof(item->name), "%s", name);
+    return item;
+}
+
+obs_data_t *obs_data_create(void)
+{
+    obs_data_t *data = bzalloc(sizeof(obs_data_t));
+    data->refs = 1;
+    return data;
+}
+
+void obs_data_release(obs_data_t *data)
+{
+    if (data && --data->refs == 0) bfree(data);
+}
+
+void obs_data_set_default_int(obs_data_t *data, const char *name, long long val)
+{
+    struct obs_data_item *item = get_item(data, name, true);
+    item->default_value = val;
+    item->has_default = true;
+}
+
+void obs_data_set_default_bool(obs_data_t *data, const char *name, bool val)
+{
+    obs_data_set_default_int(data, name, val);
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+    struct obs_data_item *item = get_item(data, name, true);
+    item->value = val;
+    item->has_value = true;
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+    obs_data_set_int(data, name, val);
+}
+
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+    const struct obs_data_item *item = get_item(data, name, false);
+    return !item ? 0 : item->has_value ? item->value : item->default_value;
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+    return obs_data_get_int(data, name) != 0;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- PROCEDURES
+
+struct proc_handler {
+    struct {
+        char name[MAX_NAMES];
+        proc_handler_proc_t proc;
+        void *data;
+    } procs[MAX_PROCS];
+    size_t count;
+};
+
+static proc_handler_t global_procs;
+
+proc_handler_t *obs_get_proc_handler(void)
+{
+    return &global_procs;
+}
+
+// only the name of the declaration matters, "void name(out int value)"
+void proc_handler_add(proc_handler_t *handler, const char *decl_string, proc_handler_proc_t proc, void *data)
+{
+    const char *name = strchr(decl_string, ' ');
+    const char *end = strchr(decl_string, '(');
+
+    if (!name || !end || end <= name || handler->count == MAX_PROCS) {
+        blog(LOG_ERROR, "proc_handler_add: bad declaration '%s'", decl_string);
+        return;
+    }
+
+    name++;
+    snprintf(handler->procs[handler->count].name, MAX_NAMES, "%.*s", (int)(end - name), name);
+    handler->procs[handler->count].proc = proc;
+    handler->procs[handler->count].data = data;
+    handler->count++;
+}
+
+bool proc_handler_call(proc_handler_t *handler, const char *name, calldata_t *params)
+{
+    for (size_t i = 0u; i < handler->count; i++) {
+        if (strcmp(handler->procs[i].name, name)) continue;
+        handler->procs[i].proc(handler->procs[i].data, params);
+        return true;
+    }
+    return false;
+}
+
+void calldata_set_int(calldata_t *data, const char *name, long long val)
+{
+    for (size_t i = 0u; i < data->count; i++) {
+        if (!strcmp(data->items[i].name, name)) {
+            data->items[i].value = val;
+            return;
+        }
+    }
+
+    if (data->count == sizeof(data->items) / sizeof(data->items[0])) return;
+
+    snprintf(data->items[data->count].name, sizeof(data->items[0].name), "%s", name);
+    data->items[data->count++].value = val;
+}
+
+void calldata_set_bool(calldata_t *data, const char *name, bool val)
+{
+    calldata_set_int(data, name, val);
+}
+
+long long calldata_int(const calldata_t *data, const char *name)
+{
+    for (size_t i = 0u; i < data->count; i++) {
+        if (!strcmp(data->items[i].name, name)) return data->items[i].value;
+    }
+    return 0;
+}
+
+bool calldata_bool(const calldata_t *data, const char *name)
+{
+    return calldata_int(data, name) != 0;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- PROPERTIES
+
+struct obs_property {
+    char name[MAX_NAMES];
+    enum obs_property_type type;
+    bool enabled;
+    bool visible;
+    size_t list_items;
+    obs_properties_t *group;
+    obs_property_modified2_t modified;
+    void *priv;
+    struct obs_property *next;
+};
+
+struct obs_properties {
+    struct obs_property *first;
+    struct obs_property *last;
+};
+
+obs_properties_t *obs_properties_create(void)
+{
+    return bzalloc(sizeof(obs_properties_t));
+}
+
+void obs_properties_destroy(obs_properties_t *props)
+{
+    if (!props) return;
+
+    for (struct obs_property *p = props->first, *next; p; p = next) {
+        next = p->next;
+        obs_properties_destroy(p->group);
+        bfree(p);
+    }
+    bfree(props);
+}
+
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *property)
+{
+    for (struct obs_property *p = props->first; p; p = p->next) {
+        if (!strcmp(p->name, property)) return p;
+
+        if (p->group) {
+            obs_property_t *found = obs_properties_get(p->group, property);
+            if (found) return found;
+        }
+    }
+    return NULL;
+}
+
+static obs_property_t *add_property(obs_properties_t *props, const char *name, enum obs_property_type type)
+{
+    if (obs_properties_get(props, name)) {
+        blog(LOG_ERROR, "property '%s' added twice", name);
+        return NULL;
+    }
+
+    struct obs_property *p = bzalloc(sizeof(struct obs_property));
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    p->type = type;
+    p->enabled = p->visible = true;
+
+    if (props->last) props->last->next = p;
+    else props->first = p;
+    props->last = p;
+
+    return p;
+}
+
+obs_property_t *obs_properties_add_bool(obs_properties_t *props, const char *name, const char *description)
+{
+    UNUSED_PARAMETER(description);
+    return add_property(props, name, OBS_PROPERTY_BOOL);
+}
+
+obs_property_t *obs_properties_add_int_slider(obs_properties_t *props, const char *name, const char *description, int min, int max, int step)
+{
+    UNUSED_PARAMETER(description);
+    UNUSED_PARAMETER(step);
+
+    if (min > max) blog(LOG_ERROR, "property '%s' has an empty range", name);
+    return add_property(props, name, OBS_PROPERTY_INT);
+}
+
+obs_property_t *obs_properties_add_list(obs_properties_t *props, const char *name, const char *description, enum obs_combo_type type,
+                                        enum obs_combo_format format)
+{
+    UNUSED_PARAMETER(description);
+    UNUSED_PARAMETER(type);
+    UNUSED_PARAMETER(format);
+    return add_property(props, name, OBS_PROPERTY_LIST);
+}
+
+obs_property_t *obs_properties_add_color(obs_properties_t *props, const char *name, const char *description)
+{
+    UNUSED_PARAMETER(description);
+    return add_property(props, name, OBS_PROPERTY_COLOR);
+}
+
+obs_property_t *obs_properties_add_button2(obs_properties_t *props, const char *name, const char *text, obs_property_clicked_t callback, void *priv)
+{
+    UNUSED_PARAMETER(text);
+    UNUSED_PARAMETER(callback);
+
+    obs_property_t *p = add_property(props, name, OBS_PROPERTY_BUTTON);
+    if (p) p->priv = priv;
+    return p;
+}
+
+obs_property_t *obs_properties_add_group(obs_properties_t *props, const char *name, const char *description, enum obs_group_type type,
+                                         obs_properties_t *group)
+{
+    UNUSED_PARAMETER(description);
+    UNUSED_PARAMETER(type);
+
+    obs_property_t *p = add_property(props, name, OBS_PROPERTY_GROUP);
+    if (p) p->group = group;
+    return p;
+}
+
+size_t obs_property_list_add_int(obs_property_t *p, const char *name, long long val)
+{
+    UNUSED_PARAMETER(name);
+    UNUSED_PARAMETER(val);
+    return p ? p->list_items++ : 0u;
+}
+
+void obs_property_set_modified_callback2(obs_property_t *p, obs_property_modified2_t modified, void *priv)
+{
+    if (!p) return;
+    p->modified = modified;
+    p->priv = priv;
+}
+
+void obs_property_set_enabled(obs_property_t *p, bool enabled)
+{
+    if (p) p->enabled = enabled;
+}
+
+void obs_property_set_visible(obs_property_t *p, bool visible)
+{
+    if (p) p->visible = visible;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- GRAPHICS
+
+struct gs_texture {
+    uint32_t width;
+    uint32_t height;
+    enum gs_color_format format;
+    bool dynamic;
+    enum gs_color_space space; // what was last rendered into it
+    float pixels[STAND_IN_PIXELS];
+};
+
+struct gs_texture_render {
+    enum gs_color_format format;
+    gs_texture_t *texture;
+    bool rendered;
+};
+
+struct gs_effect_param {
+    char name[MAX_NAMES];
+    gs_texture_t *texture;
+};
+
+struct gs_effect {
+    char *techniques;
+    size_t technique_count;
+    struct gs_effect_param *params;
+    size_t param_count;
+    const char *looping;
+};
+
+struct gs_timer {
+    bool ended;
+};
+
+struct gs_timer_range {
+    bool ended;
+};
+
+struct blend_state {
+    bool enabled;
+    enum gs_blend_type src;
+    enum gs_blend_type dst;
+};
+
+static struct {
+    uint32_t cx, cy;
+    enum gs_color_space space;
+    gs_texture_t *texture;
+} targets[MAX_TARGETS];
+static int target_depth = 0;
+
+static struct blend_state blend = {true, GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA};
+static struct blend_state blend_states[MAX_BLEND_STATES];
+static int blend_depth = 0;
+
+static bool framebuffer_srgb = false;
+
+static const char *current_technique = NULL;
+static const gs_effect_t *current_effect = NULL;
+
+static gs_effect_t *default_effect = NULL;
+
+// the pixels being drawn to, the canvas when no texrender is bound
+static float *target_pixels(void)
+{
+    return target_depth ? targets[target_depth - 1].texture->pixels : stand_in_recording.output;
+}
+
+// what libobs does to a source drawn into another space. grey stays grey through the rec2020 round trip of the
+// tonemap, so only its reinhard curve is left
+static float convert_level(float level, enum gs_color_space from, enum gs_color_space to)
+{
+    const float sdr_white = obs_get_video_sdr_white_level();
+    const bool to_sdr = to == GS_CS_SRGB || to == GS_CS_SRGB_16F;
+
+    switch (from) {
+      case GS_CS_709_EXTENDED:
+        if (to_sdr) return level / (level + 1.0f);
+        return to == GS_CS_709_SCRGB ? level * sdr_white / 80.0f : level;
+      case GS_CS_709_SCRGB:
+        if (to == GS_CS_709_SCRGB) return level;
+        level *= 80.0f / sdr_white;
+        return to_sdr ? level / (level + 1.0f) : level;
+      default: return to == GS_CS_709_SCRGB ? level * sdr_white / 80.0f : level;
+    }
+}
+
+// calls that need the graphics context in libobs
+static void graphics_call(const char *name)
+{
+    if (graphics_depth > 0) return;
+
+    stand_in_recording.unlocked_calls++;
+    blog(LOG_ERROR, "%s called outside the graphics context", name);
+}
+
+void obs_enter_graphics(void)
+{
+    graphics_depth++;
+}
+
+void obs_leave_graphics(void)
+{
+    if (graphics_depth == 0) blog(LOG_ERROR, "obs_leave_graphics without obs_enter_graphics");
+    else graphics_depth--;
+}
+
+static void add_name(char **names, size_t *count, const char *name, size_t length)
+{
+    *names = brealloc(*names, MAX_NAMES * (*count + 1u));
+    snprintf(&(*names)[MAX_NAMES * *count], MAX_NAMES, "%.*s", (int)length, name);
+    (*count)++;
+}
+
+static gs_effect_t *create_effect(const char *source)
+{
+    gs_effect_t *effect = bzalloc(sizeof(gs_effect_t));
+
+    char *params = NULL;
+
+    // enough of the effect syntax to know its techniques and uniforms
+    for (const char *line = source; line && *line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+
+        const char *keyword = line;
+        while (*keyword == ' ' || *keyword == '\t') keyword++;
+
+        if (!strncmp(keyword, "technique ", 10)) {
+            const char *name = keyword + 10;
+            add_name(&effect->techniques, &effect->technique_count, name, strcspn(name, " \t\r\n{"));
+        }
+        else if (!strncmp(keyword, "uniform ", 8)) {
+            const char *type_end = strchr(keyword + 8, ' ');
+            if (!type_end) continue;
+            const char *name = type_end + 1;
+            add_name(&params, &effect->param_count, name, strcspn(name, " \t\r\n;:"));
+        }
+    }
+
+    effect->params = bzalloc(sizeof(struct gs_effect_param) * (effect->param_count + 1u));
+    for (size_t i = 0u; i < effect->param_count; i++) memcpy(effect->params[i].name, &params[MAX_NAMES * i], MAX_NAMES);
+    bfree(params);
+
+    graphics_objects++;
+    return effect;
+}
+
+gs_effect_t *gs_effect_create_from_file(const char *file, char **error_string)
+{
+    graphics_call("gs_effect_create_from_file");
+
+    if (error_string) *error_string = NULL;
+
+    FILE *f = fopen(file, "rb");
+    if (!f) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *source = bzalloc((size_t)size + 1u);
+    const bool read = fread(source, 1, (size_t)size, f) == (size_t)size;
+    fclose(f);
+
+    gs_effect_t *effect = read ? create_effect(source) : NULL;
+    bfree(source);
+
+    return effect;
+}
+
+void gs_effect_destroy(gs_effect_t *effect)
+{
+    graphics_call("gs_effect_destroy");
+
+    if (!effect) return;
+
+    bfree(effect->techniques);
+    bfree(effect->params);
+    bfree(effect);
+    graphics_objects--;
+}
+
+gs_effect_t *obs_get_base_effect(enum obs_base_effect effect)
+{
+    UNUSED_PARAMETER(effect);
+
+    if (!default_effect) {
+        default_effect = create_effect("uniform texture2d image;\ntechnique Draw\n");
+        graphics_objects--; // owned by libobs, not the plugin
+    }
+    return default_effect;
+}
+
+gs_eparam_t *gs_effect_get_param_by_name(const gs_effect_t *effect, const char *name)
+{
+    for (size_t i = 0u; i < effect->param_count; i++) {
+        if (!strcmp(effect->params[i].name, name)) return &effect->params[i];
+    }
+    return NULL;
+}
+
+bool gs_effect_loop(gs_effect_t *effect, const char *name)
+{
+    graphics_call("gs_effect_loop");
+
+    // a single pass, the second call ends the loop
+    if (effect->looping) {
+        effect->looping = NULL;
+        current_technique = NULL;
+        current_effect = NULL;
+        return false;
+    }
+
+    for (size_t i = 0u; i < effect->technique_count; i++) {
+        if (strcmp(&effect->techniques[MAX_NAMES * i], name)) continue;
+
+        effect->looping = current_technique = &effect->techniques[MAX_NAMES * i];
+        current_effect = effect;
+        return true;
+    }
+
+    blog(LOG_ERROR, "gs_effect_loop: technique '%s' doesn't exist", name);
+    return false;
+}
+
+static void set_param(gs_eparam_t *param, const char *func)
+{
+    if (!param) blog(LOG_ERROR, "%s: invalid param", func);
+}
+
+void gs_effect_set_bool(gs_eparam_t *param, bool val)
+{
+    UNUSED_PARAMETER(val);
+    set_param(param, "gs_effect_set_bool");
+}
+
+void gs_effect_set_float(gs_eparam_t *param, float val)
+{
+    UNUSED_PARAMETER(val);
+    set_param(param, "gs_effect_set_float");
+}
+
+void gs_effect_set_vec2(gs_eparam_t *param, const struct vec2 *val)
+{
+    UNUSED_PARAMETER(val);
+    set_param(param, "gs_effect_set_vec2");
+}
+
+void gs_effect_set_vec3(gs_eparam_t *param, const struct vec3 *val)
+{
+    UNUSED_PARAMETER(val);
+    set_param(param, "gs_effect_set_vec3");
+}
+
+void gs_effect_set_vec4(gs_eparam_t *param, const struct vec4 *val)
+{
+    UNUSED_PARAMETER(val);
+    set_param(param, "gs_effect_set_vec4");
+}
+
+void gs_effect_set_texture(gs_eparam_t *param, gs_texture_t *val)
+{
+    set_param(param, "gs_effect_set_texture");
+    if (param) param->texture = val;
+}
+
+void gs_effect_set_texture_srgb(gs_eparam_t *param, gs_texture_t *val)
+{
+    set_param(param, "gs_effect_set_texture_srgb");
+    if (param) param->texture = val;
+}
+
+static uint32_t texture_bytes(const gs_texture_t *tex)
+{
+    switch (tex->format) {
+      case GS_A8:
+      case GS_R8: return tex->width * tex->height;
+      case GS_R16: return tex->width * tex->height * 2u;
+      case GS_RGBA16:
+      case GS_RGBA16F: return tex->width * tex->height * 8u;
+      case GS_RGBA32F: return tex->width * tex->height * 16u;
+      default: return tex->width * tex->height * 4u;
+    }
+}
+
+gs_texture_t *gs_texture_create(uint32_t width, uint32_t height, enum gs_color_format color_format, uint32_t levels, const uint8_t **data, uint32_t flags)
+{
+    UNUSED_PARAMETER(levels);
+
+    graphics_call("gs_texture_create");
+
+    gs_texture_t *tex = bzalloc(sizeof(gs_texture_t));
+    tex->width = width;
+    tex->height = height;
+    tex->format = color_format;
+    tex->dynamic = (flags & GS_DYNAMIC) != 0;
+
+    if (data && data[0]) {
+        stand_in_recording.texture_uploads++;
+        stand_in_recording.upload_bytes += texture_bytes(tex);
+    }
+
+    graphics_objects++;
+    return tex;
+}
+
+void gs_texture_destroy(gs_texture_t *tex)
+{
+    graphics_call("gs_texture_destroy");
+
+    if (!tex) return;
+
+    bfree(tex);
+    graphics_objects--;
+}
+
+void gs_texture_set_image(gs_texture_t *tex, const uint8_t *data, uint32_t linesize, bool invert)
+{
+    UNUSED_PARAMETER(data);
+    UNUSED_PARAMETER(linesize);
+    UNUSED_PARAMETER(invert);
+
+    graphics_call("gs_texture_set_image");
+
+    if (!tex) return;
+
+    // only dynamic textures can be mapped for writing
+    if (!tex->dynamic) blog(LOG_ERROR, "gs_texture_set_image: texture isn't dynamic");
+
+    stand_in_recording.texture_uploads++;
+    stand_in_recording.upload_bytes += texture_bytes(tex);
+}
+
+void gs_copy_texture_region(gs_texture_t *dst, uint32_t dst_x, uint32_t dst_y, gs_texture_t *src, uint32_t src_x, uint32_t src_y, uint32_t src_w, uint32_t src_h)
+{
+    graphics_call("gs_copy_texture_region");
+
+    // Direct3D 11 can't copy into a dynamic texture, nor between formats
+    if (!dst || !src || dst->dynamic || dst->format != src->format || src_x + src_w > src->width || src_y + src_h > src->height ||
+        dst_x + src_w > dst->width || dst_y + src_h > dst->height) {
+        blog(LOG_ERROR, "gs_copy_texture_region: invalid copy");
+        return;
+    }
+
+    stand_in_recording.texture_copies++;
+}
+
+gs_texrender_t *gs_texrender_create(enum gs_color_format format, enum gs_zstencil_format zsformat)
+{
+    UNUSED_PARAMETER(zsformat);
+
+    graphics_call("gs_texrender_create");
+
+    gs_texrender_t *texrender = bzalloc(sizeof(gs_texrender_t));
+    texrender->format = format;
+
+    graphics_objects++;
+    return texrender;
+}
+
+void gs_texrender_destroy(gs_texrender_t *texrender)
+{
+    graphics_call("gs_texrender_destroy");
+
+    if (!texrender) return;
+
+    if (texrender->texture) gs_texture_destroy(texrender->texture);
+    bfree(texrender);
+    graphics_objects--;
+}
+
+void gs_texrender_reset(gs_texrender_t *texrender)
+{
+    if (texrender) texrender->rendered = false;
+}
+
+bool gs_texrender_begin_with_color_space(gs_texrender_t *texrender, uint32_t cx, uint32_t cy, enum gs_color_space space)
+{
+    graphics_call("gs_texrender_begin_with_color_space");
+
+    if (!texrender || texrender->rendered || !cx || !cy || target_depth == MAX_TARGETS) return false;
+
+    if (texrender->texture && (texrender->texture->width != cx || texrender->texture->height != cy)) {
+        gs_texture_destroy(texrender->texture);
+        texrender->texture = NULL;
+    }
+
+    if (!texrender->texture) texrender->texture = gs_texture_create(cx, cy, texrender->format, 1, NULL, 0);
+
+    texrender->texture->space = space;
+
+    targets[target_depth].cx = cx;
+    targets[target_depth].cy = cy;
+    targets[target_depth].space = space;
+    targets[target_depth].texture = texrender->texture;
+    target_depth++;
+
+    stand_in_recording.texrender_passes++;
+    return true;
+}
+
+void gs_texrender_end(gs_texrender_t *texrender)
+{
+    graphics_call("gs_texrender_end");
+
+    if (target_depth > 0) target_depth--;
+    texrender->rendered = true;
+}
+
+gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender)
+{
+    return texrender ? texrender->texture : NULL;
+}
+
+gs_timer_t *gs_timer_create(void)
+{
+    graphics_call("gs_timer_create");
+    graphics_objects++;
+    return bzalloc(sizeof(gs_timer_t));
+}
+
+void gs_timer_destroy(gs_timer_t *timer)
+{
+    graphics_call("gs_timer_destroy");
+
+    if (!timer) return;
+
+    bfree(timer);
+    graphics_objects--;
+}
+
+void gs_timer_begin(gs_timer_t *timer)
+{
+    graphics_call("gs_timer_begin");
+
+    timer->ended = false;
+    stand_in_recording.timer_queries++;
+}
+
+void gs_timer_end(gs_timer_t *timer)
+{
+    graphics_call("gs_timer_end");
+    timer->ended = true;
+}
+
+bool gs_timer_get_data(gs_timer_t *timer, uint64_t *ticks)
+{
+    if (!timer->ended) return false;
+
+    *ticks = (uint64_t)(stand_in_config.gpu_ms * 1000000.0f);
+    return true;
+}
+
+gs_timer_range_t *gs_timer_range_create(void)
+{
+    graphics_call("gs_timer_range_create");
+    graphics_objects++;
+    return bzalloc(sizeof(gs_timer_range_t));
+}
+
+void gs_timer_range_destroy(gs_timer_range_t *range)
+{
+    graphics_call("gs_timer_range_destroy");
+
+    if (!range) return;
+
+    bfree(range);
+    graphics_objects--;
+}
+
+void gs_timer_range_begin(gs_timer_range_t *range)
+{
+    graphics_call("gs_timer_range_begin");
+    range->ended = false;
+}
+
+void gs_timer_range_end(gs_timer_range_t *range)
+{
+    graphics_call("gs_timer_range_end");
+    range->ended = true;
+}
+
+bool gs_timer_range_get_data(gs_timer_range_t *range, bool *disjoint, uint64_t *frequency)
+{
+    if (!range->ended) return false;
+
+    *disjoint = false;
+    *frequency = 1000000000u;
+    return true;
+}
+
+static void record_draw(const char *technique, uint32_t cx, uint32_t cy)
+{
+    if (stand_in_recording.draw_count == STAND_IN_MAX_DRAWS) return;
+
+    struct stand_in_draw *draw = &stand_in_recording.draws[stand_in_recording.draw_count++];
+
+    snprintf(draw->technique, sizeof(draw->technique), "%s", technique ? technique : "");
+    draw->cx = cx;
+    draw->cy = cy;
+    draw->target_cx = target_depth ? targets[target_depth - 1].cx : 0u;
+    draw->target_cy = target_depth ? targets[target_depth - 1].cy : 0u;
+    draw->blending = blend.enabled;
+    draw->src = blend.src;
+    draw->dst = blend.dst;
+    draw->srgb = framebuffer_srgb;
+
+    const gs_eparam_t *pattern = current_effect ? gs_effect_get_param_by_name(current_effect, "tex_c") : NULL;
+    draw->pattern = pattern ? pattern->texture : NULL;
+}
+
+// what a pass leaves in the target: textures are sampled as they are, whatever space they were rendered in. the melt
+// takes the covered pixel from A and the uncovered one from B, or leaves it to the target when drawn over it.
+// colour operations aren't followed, only where each pixel comes from
+static void draw_pixels(void)
+{
+    if (!current_effect) return;
+
+    float *pixels = target_pixels();
+
+    const gs_eparam_t *image = gs_effect_get_param_by_name(current_effect, "image");
+    if (image) {
+        if (image->texture) memcpy(pixels, image->texture->pixels, sizeof(image->texture->pixels));
+        return;
+    }
+
+    const gs_eparam_t *a = gs_effect_get_param_by_name(current_effect, "tex_a");
+    const gs_eparam_t *b = gs_effect_get_param_by_name(current_effect, "tex_b");
+    if (!a || !b) return;
+
+    if (a->texture) pixels[0] = a->texture->pixels[0];
+    if (b->texture && !strstr(current_technique, "Over")) pixels[1] = b->texture->pixels[1];
+}
+
+void gs_draw_sprite(gs_texture_t *tex, uint32_t flip, uint32_t width, uint32_t height)
+{
+    UNUSED_PARAMETER(flip);
+
+    graphics_call("gs_draw_sprite");
+
+    if (!current_technique) blog(LOG_ERROR, "gs_draw_sprite outside of an effect loop");
+
+    record_draw(current_technique, width ? width : tex ? tex->width : 0u, height ? height : tex ? tex->height : 0u);
+    draw_pixels();
+}
+
+void gs_clear(uint32_t clear_flags, const struct vec4 *color, float depth, uint8_t stencil)
+{
+    UNUSED_PARAMETER(depth);
+    UNUSED_PARAMETER(stencil);
+
+    graphics_call("gs_clear");
+
+    if (!(clear_flags & GS_CLEAR_COLOR) || !color) return;
+
+    float *pixels = target_pixels();
+    for (int i = 0; i < STAND_IN_PIXELS; i++) pixels[i] = color->x;
+}
+
+void gs_ortho(float left, float right, float top, float bottom, float znear, float zfar)
+{
+    UNUSED_PARAMETER(left);
+    UNUSED_PARAMETER(right);
+    UNUSED_PARAMETER(top);
+    UNUSED_PARAMETER(bottom);
+    UNUSED_PARAMETER(znear);
+    UNUSED_PARAMETER(zfar);
+
+    graphics_call("gs_ortho");
+}
+
+void gs_blend_state_push(void)
+{
+    graphics_call("gs_blend_state_push");
+    if (blend_depth < MAX_BLEND_STATES) blend_states[blend_depth++] = blend;
+}
+
+void gs_blend_state_pop(void)
+{
+    graphics_call("gs_blend_state_pop");
+    if (blend_depth > 0) blend = blend_states[--blend_depth];
+}
+
+void gs_enable_blending(bool enable)
+{
+    blend.enabled = enable;
+}
+
+void gs_blend_function(enum gs_blend_type src, enum gs_blend_type dest)
+{
+    blend.src = src;
+    blend.dst = dest;
+}
+
+bool gs_framebuffer_srgb_enabled(void)
+{
+    return framebuffer_srgb;
+}
+
+void gs_enable_framebuffer_srgb(bool enable)
+{
+    framebuffer_srgb = enable;
+}
+
+enum gs_color_space gs_get_color_space(void)
+{
+    return target_depth ? targets[target_depth - 1].space : stand_in_config.color_space;
+}
+
+enum gs_color_format gs_get_format_from_space(enum gs_color_space space)
+{
+    return space == GS_CS_SRGB ? GS_RGBA : GS_RGBA16F;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- SOURCES
+
+struct obs_source {
+    const struct obs_source_info *info;
+    void *data;
+    obs_data_t *settings;
+    char name[MAX_NAMES];
+    uint32_t cx, cy;
+    proc_handler_t procs;
+
+    bool transitioning;
+    float t;
+    struct obs_source *scenes[2];
+    int current; // scene shown while not transitioning
+    const float *level; // scenes only, what they render
+};
+
+static obs_source_t *create_scene(const char *name, uint32_t cx, uint32_t cy)
+{
+    obs_source_t *scene = bzalloc(sizeof(obs_source_t));
+    snprintf(scene->name, sizeof(scene->name), "%s", name);
+    scene->cx = cx;
+    scene->cy = cy;
+    return scene;
+}
+
+obs_source_t *stand_in_create_transition(const char *id, const char *name, obs_data_t *settings, uint32_t cx, uint32_t cy)
+{
+    const struct obs_source_info *info = NULL;
+
+    for (size_t i = 0u; i < type_count && !info; i++) {
+        if (!strcmp(types[i]->id, id)) info = types[i];
+    }
+
+    if (!info || info->type != OBS_SOURCE_TYPE_TRANSITION) return NULL;
+
+    obs_source_t *source = create_scene(name, cx, cy);
+    source->info = info;
+    source->settings = settings;
+    source->scenes[0] = create_scene("scene A", cx, cy);
+    source->scenes[1] = create_scene("scene B", cx, cy);
+    source->scenes[0]->level = &stand_in_config.scene_levels[0];
+    source->scenes[1]->level = &stand_in_config.scene_levels[1];
+    settings->refs++;
+
+    source->data = info->create(settings, source);
+
+    if (!source->data) {
+        stand_in_destroy(source);
+        return NULL;
+    }
+
+    // the update requested from create is deferred until it returns, libobs has no data to pass before that
+    if (info->update) info->update(source->data, settings);
+
+    return source;
+}
+
+void stand_in_destroy(obs_source_t *source)
+{
+    if (source->data && source->info->destroy) source->info->destroy(source->data);
+
+    bfree(source->scenes[0]);
+    bfree(source->scenes[1]);
+    obs_data_release(source->settings);
+    bfree(source);
+}
+
+void stand_in_set_scene_size(obs_source_t *transition, uint32_t cx, uint32_t cy)
+{
+    for (int i = 0; i < 2; i++) {
+        transition->scenes[i]->cx = cx;
+        transition->scenes[i]->cy = cy;
+    }
+}
+
+void stand_in_start(obs_source_t *transition)
+{
+    transition->transitioning = true;
+    transition->t = .0f;
+    transition->current = 0;
+
+    if (transition->info->transition_start) transition->info->transition_start(transition->data);
+}
+
+static void stop_transition(obs_source_t *transition)
+{
+    transition->transitioning = false;
+    transition->current = 1;
+
+    if (transition->info->transition_stop) transition->info->transition_stop(transition->data);
+}
+
+void stand_in_render(obs_source_t *transition, float t)
+{
+    transition->t = t;
+
+    const enum gs_color_space canvas = stand_in_config.color_space;
+    const enum gs_color_space space = transition->info->video_get_color_space ? transition->info->video_get_color_space(transition->data, 1, &canvas)
+                                                                              : GS_CS_SRGB;
+
+    obs_enter_graphics();
+
+    if (space == canvas) transition->info->video_render(transition->data, NULL);
+    else {
+        gs_texrender_t *texrender = gs_texrender_create(gs_get_format_from_space(space), GS_ZS_NONE);
+
+        if (gs_texrender_begin_with_color_space(texrender, transition->cx, transition->cy, space)) {
+            transition->info->video_render(transition->data, NULL);
+            gs_texrender_end(texrender);
+            record_draw("Convert", transition->cx, transition->cy);
+
+            const gs_texture_t *tex = gs_texrender_get_texture(texrender);
+            for (int i = 0; i < STAND_IN_PIXELS; i++) stand_in_recording.output[i] = convert_level(tex->pixels[i], space, canvas);
+        }
+
+        gs_texrender_destroy(texrender);
+    }
+
+    obs_leave_graphics();
+
+    if (target_depth) blog(LOG_ERROR, "a texrender was left bound after the frame");
+}
+
+bool stand_in_transitioning(const obs_source_t *transition)
+{
+    return transition->transitioning;
+}
+
+const struct stand_in_draw *stand_in_find_draw(const char *prefix)
+{
+    for (uint32_t i = 0u; i < stand_in_recording.draw_count; i++) {
+        if (!strncmp(stand_in_recording.draws[i].technique, prefix, strlen(prefix))) return &stand_in_recording.draws[i];
+    }
+    return NULL;
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+    return source->name;
+}
+
+uint32_t obs_source_get_width(obs_source_t *source)
+{
+    return source->cx;
+}
+
+uint32_t obs_source_get_height(obs_source_t *source)
+{
+    return source->cy;
+}
+
+void obs_source_update(obs_source_t *source, obs_data_t *settings)
+{
+    if (settings && settings != source->settings) blog(LOG_ERROR, "obs_source_update: the stand-in doesn't merge settings");
+    if (source->data && source->info->update) source->info->update(source->data, source->settings);
+}
+
+void obs_source_video_render(obs_source_t *source)
+{
+    record_draw(source->name, source->cx, source->cy);
+
+    if (!source->level) return;
+
+    // libobs converts the scene into whatever space it's being drawn to
+    const float level = convert_level(*source->level, stand_in_config.source_space, gs_get_color_space());
+
+    float *pixels = target_pixels();
+    for (int i = 0; i < STAND_IN_PIXELS; i++) pixels[i] = level;
+}
+
+void obs_source_release(obs_source_t *source)
+{
+    UNUSED_PARAMETER(source);
+}
+
+proc_handler_t *obs_source_get_proc_handler(const obs_source_t *source)
+{
+    return (proc_handler_t *)&source->procs;
+}
+
+obs_source_t *obs_transition_get_source(obs_source_t *transition, enum obs_transition_target target)
+{
+    return transition->scenes[target];
+}
+
+float obs_transition_get_time(obs_source_t *transition)
+{
+    return transition->transitioning ? transition->t : 1.0f;
+}
+
+void obs_transition_video_render(obs_source_t *transition, obs_transition_video_render_callback_t callback)
+{
+    graphics_call("obs_transition_video_render");
+
+    if (transition->transitioning && transition->t >= 1.0f) stop_transition(transition);
+
+    if (!transition->transitioning) {
+        obs_source_video_render(transition->scenes[transition->current]);
+        return;
+    }
+
+    // both scenes go through a texture of the transition's size first, in the space being drawn to
+    const enum gs_color_space space = gs_get_color_space();
+    gs_texture_t *textures[2];
+
+    for (int i = 0; i < 2; i++) {
+        gs_texrender_t *texrender = gs_texrender_create(gs_get_format_from_space(space), GS_ZS_NONE);
+        if (gs_texrender_begin_with_color_space(texrender, transition->cx, transition->cy, space)) {
+            obs_source_video_render(transition->scenes[i]);
+            gs_texrender_end(texrender);
+        }
+        textures[i] = texrender->texture;
+        texrender->texture = NULL;
+        gs_texrender_destroy(texrender);
+    }
+
+    callback(transition->data, textures[0], textures[1], transition->t, transition->cx, transition->cy);
+
+    gs_texture_destroy(textures[0]);
+    gs_texture_destroy(textures[1]);
+}
+
+bool obs_transition_video_render_direct(obs_source_t *transition, enum obs_transition_target target)
+{
+    graphics_call("obs_transition_video_render_direct");
+
+    if (transition->transitioning && transition->t >= 1.0f) stop_transition(transition);
+
+    if (!transition->transitioning) {
+        obs_source_video_render(transition->scenes[transition->current]);
+        return false;
+    }
+
+    obs_source_video_render(transition->scenes[target]);
+    return true;
+}
+
+enum gs_color_space obs_transition_video_get_color_space(obs_source_t *transition)
+{
+    UNUSED_PARAMETER(transition);
+    return stand_in_config.source_space;
+}
+
+bool obs_transition_audio_render(obs_source_t *transition, uint64_t *ts_out, struct obs_source_audio_mix *audio, uint32_t mixers, size_t channels,
+                                 size_t sample_rate, obs_transition_audio_mix_callback_t mix_a, obs_transition_audio_mix_callback_t mix_b)
+{
+    UNUSED_PARAMETER(ts_out);
+    UNUSED_PARAMETER(audio);
+    UNUSED_PARAMETER(mixers);
+    UNUSED_PARAMETER(channels);
+    UNUSED_PARAMETER(sample_rate);
+
+    mix_a(transition->data, transition->t);
+    mix_b(transition->data, transition->t);
+    return false;
+}
+
+#pragma endregion
+
+void stand_in_init(const char *config, const char *data)
+{
+    snprintf(config_dir, sizeof(config_dir), "%s", config);
+    snprintf(data_dir, sizeof(data_dir), "%s", data);
+
+    os_mkdirs(config_dir);
+
+    const char *verbose = getenv("MELTSCR_TEST_VERBOSE");
+    stand_in_config.verbose = verbose && *verbose && strcmp(verbose, "0");
+
+    stand_in_reset_recording();
+}
+
+void stand_in_shutdown(void)
+{
+    if (default_effect) {
+        graphics_objects++;
+        obs_enter_graphics();
+        gs_effect_destroy(default_effect);
+        obs_leave_graphics();
+        default_effect = NULL;
+    }
+
+    memset(&global_procs, 0, sizeof(global_procs));
+    type_count = 0u;
+}
+
+void stand_in_reset_recording(void)
+{
+    memset(&stand_in_recording, 0, sizeof(stand_in_recording));
+}
+
+long stand_in_graphics_objects(void)
+{
+    return graphics_objects;
+}
+
+size_t stand_in_allocated_bytes(void)
+{
+    return allocated_bytes;
+}
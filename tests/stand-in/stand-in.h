@@ -0,0 +1,86 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// what tests use to drive the stand-in libobs and read back what the plugin did with it
+
+#pragma once
+
+#include <obs-module.h>
+
+#define STAND_IN_MAX_DRAWS 64
+
+// grey levels followed through every surface: a pixel a melting slice still covers and one it has already uncovered
+#define STAND_IN_PIXELS 2
+
+// a sprite drawn by the plugin, or a scene libobs drew on its behalf
+struct stand_in_draw {
+    char technique[64]; // "scene A" / "scene B" for scenes
+    uint32_t cx, cy;
+    uint32_t target_cx, target_cy; // 0x0 is the output
+    bool blending;
+    enum gs_blend_type src, dst;
+    bool srgb;
+    const gs_texture_t *pattern; // what the effect's tex_c, the offsets pattern, was bound to
+};
+
+// everything since the last stand_in_reset_recording
+struct stand_in_recording {
+    struct stand_in_draw draws[STAND_IN_MAX_DRAWS];
+    uint32_t draw_count;
+    uint32_t timer_queries;
+    uint32_t texture_uploads; // creations and updates, in bytes-agnostic calls
+    uint64_t upload_bytes; // what those calls sent, whole textures each
+    uint32_t texture_copies; // GPU copies between textures
+    uint32_t texrender_passes;
+    uint32_t errors;
+    uint32_t warnings;
+    uint32_t unlocked_calls; // graphics calls made without the graphics context
+    float output[STAND_IN_PIXELS]; // what reached the canvas, in its space
+};
+
+// knobs, may be changed at any time
+struct stand_in_config {
+    float gpu_ms; // what every timer query reads back
+    enum gs_color_space color_space; // the canvas
+    enum gs_color_space source_space; // what the scenes render in
+    float scene_levels[2]; // the grey level of scenes A and B, in source_space
+    bool verbose; // logs go to stderr
+    uint32_t lagged_frames; // what libobs counts, tests raise them to simulate an overloaded machine
+    uint32_t skipped_frames;
+};
+
+extern struct stand_in_recording stand_in_recording;
+extern struct stand_in_config stand_in_config;
+
+// 'config_dir' is created if missing, 'data_dir' is where obs_module_file looks
+void stand_in_init(const char *config_dir, const char *data_dir);
+void stand_in_shutdown(void);
+
+void stand_in_reset_recording(void);
+
+// textures, texrenders, effects and timers still alive
+long stand_in_graphics_objects(void);
+
+// held through bmalloc and friends, bnum_allocs counts the blocks
+size_t stand_in_allocated_bytes(void);
+
+// runs the registered 'id' create and, like libobs does once a source is loaded, its update
+obs_source_t *stand_in_create_transition(const char *id, const char *name, obs_data_t *settings, uint32_t cx, uint32_t cy);
+void stand_in_destroy(obs_source_t *source);
+
+// scenes A and B can be sized apart from the transition, as a scaled transition would see them
+void stand_in_set_scene_size(obs_source_t *transition, uint32_t cx, uint32_t cy);
+
+// starts a transition from scene A to scene B
+void stand_in_start(obs_source_t *transition);
+
+// a frame of the transition at 't', inside the graphics context as the render thread does. t >= 1 ends it.
+// a transition whose colour space isn't the canvas' goes through a texture and a "Convert" pass, like libobs does
+void stand_in_render(obs_source_t *transition, float t);
+
+bool stand_in_transitioning(const obs_source_t *transition);
+
+// a draw whose technique starts with 'prefix', NULL if none in the current recording
+const struct stand_in_draw *stand_in_find_draw(const char *prefix);
@@ -0,0 +1,21 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// stand-in for libobs' util/platform.h, plain C library calls underneath
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <wchar.h>
+
+FILE *os_fopen(const char *path, const char *mode);
+int64_t os_ftelli64(FILE *file);
+int os_mkdirs(const char *path);
+int os_rename(const char *old_path, const char *new_path);
+int os_unlink(const char *path);
+uint64_t os_gettime_ns(void);
+size_t os_utf8_to_wcs_ptr(const char *str, size_t len, wchar_t **pstr);
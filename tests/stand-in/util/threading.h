@@ -0,0 +1,10 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// stand-in for libobs' util/threading.h
+
+#pragma once
+
+#include <pthread.h>
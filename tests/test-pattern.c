@@ -0,0 +1,162 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// the batched pattern walk has to produce exactly what the scalar one does, lane by lane,
+// over every steps and increment the properties allow.
+// usage: test-pattern [--bench], which reports how many patterns per second each walk builds instead
+
+#include "meltscr-pattern.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SLICES 1600
+#define MAX_VALUES 4096
+
+static uint32_t rng_state = 0x2545F491u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint8_t values[MAX_VALUES];
+static uint8_t batch[MAX_SLICES * PATTERN_LANES];
+static uint8_t lane[MAX_SLICES];
+static uint8_t expected[MAX_SLICES];
+
+// returns the number of mismatching lanes
+static int compare(uint16_t slices, uint32_t size, int steps, float increment, float factor)
+{
+    uint32_t starts[PATTERN_LANES], positions[PATTERN_LANES];
+
+    for (int l = 0; l < PATTERN_LANES; l++) {
+        // the last lane starts right before the wrap, it's where positions are most likely to go wrong
+        starts[l] = l == PATTERN_LANES - 1 ? size - 1u : rng() % size;
+        positions[l] = starts[l];
+    }
+
+    meltscr_pattern_offsets_batch(batch, slices, values, size, positions, steps, increment, factor);
+
+    int bad = 0;
+
+    for (int l = 0; l < PATTERN_LANES; l++) {
+        const uint32_t end = meltscr_pattern_offsets(expected, slices, values, size, starts[l], steps, increment, factor);
+        meltscr_pattern_lane(lane, batch, slices, l);
+
+        if (!memcmp(lane, expected, slices) && end == positions[l]) continue;
+
+        if (!bad) fprintf(stderr, "mismatch: slices %u, %u values, steps %d, increment %g, factor %g, lane %d from %u\n", slices, size, steps, increment, factor, l, starts[l]);
+        bad++;
+    }
+
+    return bad;
+}
+
+// patterns per second over 'seconds' of CPU time, the walk settings are the original melt's.
+// a batch counts as PATTERN_LANES patterns, left in its slice-major layout the way a pool would take them
+static double bench_rate(bool batched, uint16_t slices, uint32_t size, double seconds, uint32_t *sink)
+{
+    uint32_t positions[PATTERN_LANES];
+    for (int l = 0; l < PATTERN_LANES; l++) positions[l] = rng() % size;
+
+    uint32_t position = positions[0];
+    long patterns = 0;
+
+    const clock_t start = clock();
+    clock_t now = start;
+
+    while ((double)(now - start) < seconds * CLOCKS_PER_SEC) {
+        // the clock is only read every so often, it costs about as much as a short pattern
+        for (int i = 0; i < 64; i++) {
+            if (batched) {
+                meltscr_pattern_offsets_batch(batch, slices, values, size, positions, 16, .0625f, .6f);
+                patterns += PATTERN_LANES;
+            }
+            else {
+                position = meltscr_pattern_offsets(expected, slices, values, size, position, 16, .0625f, .6f);
+                patterns++;
+            }
+        }
+        *sink += batched ? batch[slices * PATTERN_LANES - 1] : expected[slices - 1];
+        now = clock();
+    }
+
+    return patterns / ((double)(now - start) / CLOCKS_PER_SEC);
+}
+
+static int bench(void)
+{
+    const uint16_t slices[] = {32u, 160u, 400u, 1600u};
+    const uint32_t sizes[] = {256u, MAX_VALUES};
+
+    uint32_t sink = 0u;
+
+    printf("%d lanes per batch\n", PATTERN_LANES);
+#if defined(__GNUC__) && !defined(__OPTIMIZE__)
+    printf("unoptimized build, the rates only compare in a Release one\n");
+#endif
+    printf("%8s %8s %16s %16s %8s\n", "slices", "values", "scalar/s", "batched/s", "speedup");
+
+    for (size_t v = 0u; v < sizeof(sizes) / sizeof(sizes[0]); v++) {
+        for (uint32_t i = 0u; i < sizes[v]; i++) values[i] = (uint8_t)rng();
+
+        for (size_t s = 0u; s < sizeof(slices) / sizeof(slices[0]); s++) {
+            const double scalar = bench_rate(false, slices[s], sizes[v], .25, &sink);
+            const double batched = bench_rate(true, slices[s], sizes[v], .25, &sink);
+
+            printf("%8u %8u %16.0f %16.0f %7.2fx\n", slices[s], sizes[v], scalar, batched, batched / scalar);
+        }
+    }
+
+    // keeps the walks from being optimized away
+    return sink == 0xFFFFFFFFu ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && !strcmp(argv[1], "--bench")) return bench();
+
+    int bad = 0, patterns = 0;
+
+    for (int steps = 4; steps <= 64; steps++) {
+        for (int increment = 1; increment <= 100; increment++) {
+
+            // the same bytes the plugin could have been handed, pools and tables alike
+            const uint32_t size = 1u + rng() % MAX_VALUES;
+            for (uint32_t i = 0u; i < size; i++) values[i] = (uint8_t)rng();
+
+            const uint16_t slices = (uint16_t)(2u + rng() % 190u);
+            const float factor = .01f * (int)(1u + rng() % 100u);
+
+            bad += compare(slices, size, steps, .0025f * increment, factor);
+            patterns += PATTERN_LANES;
+        }
+    }
+
+    // full width patterns, tiny value sets that wrap several times over, and the extremes of the factor
+    const uint32_t sizes[] = {1u, 2u, 3u, 256u, MAX_VALUES};
+    const int factors[] = {1, 60, 100};
+
+    for (size_t s = 0u; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (uint32_t i = 0u; i < sizes[s]; i++) values[i] = (uint8_t)rng();
+
+        for (size_t f = 0u; f < sizeof(factors) / sizeof(factors[0]); f++) {
+            for (int steps = 4; steps <= 64; steps += 4) {
+                bad += compare(MAX_SLICES, sizes[s], steps, .0625f, .01f * factors[f]);
+                bad += compare(2u, sizes[s], steps, .25f, .01f * factors[f]);
+                patterns += 2 * PATTERN_LANES;
+            }
+        }
+    }
+
+    printf("%d of %d pattern(s) differ\n", bad, patterns);
+    return bad ? 1 : 0;
+}
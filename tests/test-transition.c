@@ -0,0 +1,481 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// loads the plugin into the stand-in libobs, then creates, updates and renders transitions headless
+// usage: test-transition <data dir> <config dir>
+
+#include "stand-in.h"
+#include "plugin-common.h"
+
+#include <stdio.h>
+
+bool obs_module_load(void);
+void obs_module_unload(void);
+
+static int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                          \
+        }                                                                        \
+    } while (0)
+
+#define CX 1280u
+#define CY 720u
+
+// a whole transition at 'frames' frames, t reaches 1 on the last one like libobs' does
+static void play(obs_source_t *transition, int frames)
+{
+    stand_in_start(transition);
+    for (int i = 1; i <= frames; i++) stand_in_render(transition, (float)i / frames);
+}
+
+static void test_defaults(void)
+{
+    obs_data_t *settings = obs_data_create();
+    obs_source_t *transition = stand_in_create_transition("meltscr_transition", "melt", settings, CX, CY);
+    obs_data_release(settings);
+
+    CHECK(transition != NULL);
+    if (!transition) return;
+
+    // the table made for it is remembered in its settings
+    CHECK(obs_data_get_int(settings, "uuid") != 0);
+
+    // nothing shows up before it starts but the current scene
+    stand_in_reset_recording();
+    stand_in_render(transition, .0f);
+    CHECK(stand_in_recording.draw_count == 1u && stand_in_find_draw("scene A"));
+
+    // no colour operations, so B goes straight to the output and A melts over it
+    stand_in_reset_recording();
+    stand_in_start(transition);
+    stand_in_render(transition, .5f);
+
+    const struct stand_in_draw *b = stand_in_find_draw("scene B");
+    const struct stand_in_draw *over = stand_in_find_draw("MeltScreenOver");
+
+    CHECK(b && b->target_cx == 0u);
+    CHECK(over && over->target_cx == 0u && over->cx == CX && over->cy == CY);
+    CHECK(over && over->blending && over->src == GS_BLEND_ONE && over->dst == GS_BLEND_INVSRCALPHA);
+    CHECK(over && over->srgb);
+
+    // GPU timing stays off unless the governor or the stats need it
+    CHECK(stand_in_recording.timer_queries == 0u);
+
+    // the last frame ends it on B
+    stand_in_reset_recording();
+    stand_in_render(transition, 1.0f);
+    CHECK(!stand_in_transitioning(transition));
+    CHECK(stand_in_recording.draw_count == 1u && stand_in_find_draw("scene B"));
+
+    CHECK(stand_in_recording.errors == 0u && stand_in_recording.unlocked_calls == 0u);
+
+    stand_in_destroy(transition);
+}
+
+static void test_update(void)
+{
+    obs_data_t *settings = obs_data_create();
+    obs_source_t *transition = stand_in_create_transition("meltscr_transition", "fade", settings, CX, CY);
+
+    CHECK(transition != NULL);
+    if (!transition) {
+        obs_data_release(settings);
+        return;
+    }
+
+    // a fade touches B too, so both scenes go through the regular path
+    obs_data_set_int(settings, "fade_amount", 50);
+    obs_source_update(transition, NULL);
+
+    stand_in_reset_recording();
+    stand_in_start(transition);
+    stand_in_render(transition, .5f);
+
+    const struct stand_in_draw *fade = stand_in_find_draw("MeltScreenFade");
+    CHECK(fade && fade->target_cx == 0u && fade->cx == CX);
+    CHECK(!stand_in_find_draw("MeltScreenOver"));
+
+    const struct stand_in_draw *b = stand_in_find_draw("scene B");
+    CHECK(b && b->target_cx == CX);
+
+    // and asking for the stats times the melt pass
+    obs_data_set_bool(settings, "gpu_stats", true);
+    obs_source_update(transition, NULL);
+
+    stand_in_reset_recording();
+    stand_in_render(transition, .75f);
+    CHECK(stand_in_recording.timer_queries == 1u);
+
+    stand_in_render(transition, 1.0f);
+    CHECK(!stand_in_transitioning(transition));
+
+    // warm-ups build the next transition ahead of time, the atlas is uploaded along with it
+    stand_in_reset_recording();
+    calldata_t cd = {0};
+    CHECK(proc_handler_call(obs_source_get_proc_handler(transition), "warm_up", &cd));
+    CHECK(calldata_bool(&cd, "ready"));
+    CHECK(stand_in_recording.texture_uploads > 0u);
+
+    cd.count = 0u;
+    CHECK(proc_handler_call(obs_get_proc_handler(), "meltscr_ready_all", &cd));
+    CHECK(calldata_int(&cd, "ready") == 1 && calldata_int(&cd, "total") == 1);
+
+    // so its first frame has nothing left to upload
+    stand_in_reset_recording();
+    stand_in_start(transition);
+    stand_in_render(transition, .1f);
+    CHECK(stand_in_recording.texture_uploads == 0u);
+
+    // and don't touch one that's playing
+    cd.count = 0u;
+    CHECK(proc_handler_call(obs_source_get_proc_handler(transition), "warm_up", &cd));
+    CHECK(!calldata_bool(&cd, "ready"));
+    stand_in_render(transition, 1.0f);
+
+    CHECK(stand_in_recording.errors == 0u && stand_in_recording.unlocked_calls == 0u);
+
+    stand_in_destroy(transition);
+    obs_data_release(settings);
+}
+
+// width the melt pass renders at on a frame at 't', the output's when it draws straight to it
+static uint32_t melt_width(obs_source_t *transition, float t)
+{
+    stand_in_reset_recording();
+    stand_in_render(transition, t);
+
+    const struct stand_in_draw *melt = stand_in_find_draw("MeltScreen");
+    return !melt ? 0u : melt->target_cx ? melt->target_cx : CX;
+}
+
+static void test_governor(void)
+{
+    obs_data_t *settings = obs_data_create();
+    obs_data_set_bool(settings, "adaptive_quality", true);
+
+    obs_source_t *transition = stand_in_create_transition("meltscr_transition", "governed", settings, CX, CY);
+    obs_data_release(settings);
+
+    CHECK(transition != NULL);
+    if (!transition) return;
+
+    // well over a quarter of a 60fps frame
+    stand_in_config.gpu_ms = 10.0f;
+
+    // it starts at full resolution, a couple of timings later the rest of the same transition renders at half
+    stand_in_reset_recording();
+    stand_in_start(transition);
+    for (int i = 1; i <= 3; i++) stand_in_render(transition, i / 30.0f);
+    CHECK(stand_in_recording.timer_queries > 0u);
+    CHECK(!stand_in_find_draw("Draw"));
+
+    stand_in_reset_recording();
+    stand_in_render(transition, 4 / 30.0f);
+
+    const struct stand_in_draw *melt = stand_in_find_draw("MeltScreen");
+    const struct stand_in_draw *upscale = stand_in_find_draw("Draw");
+
+    CHECK(melt && melt->target_cx == CX / 2u && melt->target_cy == CY / 2u && melt->cx == CX);
+    CHECK(upscale && upscale->target_cx == 0u && upscale->cx == CX && upscale->cy == CY);
+    CHECK(!stand_in_find_draw("MeltScreenOver"));
+
+    // the pattern it started with carries on, nothing is uploaded for it
+    CHECK(stand_in_recording.texture_uploads == 0u);
+
+    // and still too slow, it goes down another level before the end
+    for (int i = 5; i < 29; i++) stand_in_render(transition, i / 30.0f);
+    CHECK(melt_width(transition, 29 / 30.0f) == CX / 4u);
+    stand_in_render(transition, 1.0f);
+
+    // levels only climb back between transitions, once one has been cheap enough
+    stand_in_config.gpu_ms = .1f;
+
+    stand_in_start(transition);
+    CHECK(melt_width(transition, .1f) == CX / 4u);
+    for (int i = 1; i <= 30; i++) stand_in_render(transition, .1f + i * .03f);
+
+    stand_in_start(transition);
+    CHECK(melt_width(transition, .1f) == CX / 2u);
+
+    // frames libobs couldn't render or output lower it right away, however cheap the melt pass looks
+    stand_in_config.lagged_frames += 2u;
+    CHECK(melt_width(transition, .2f) == CX / 4u);
+
+    stand_in_config.skipped_frames += 1u;
+    stand_in_render(transition, .3f);
+    for (int i = 1; i <= 30; i++) stand_in_render(transition, .3f + i * .025f);
+
+    // a transition that dropped frames doesn't count as having had headroom
+    stand_in_start(transition);
+    CHECK(melt_width(transition, .1f) == CX / 4u);
+    for (int i = 1; i <= 30; i++) stand_in_render(transition, .1f + i * .03f);
+
+    stand_in_start(transition);
+    CHECK(melt_width(transition, .1f) == CX / 2u);
+    for (int i = 1; i <= 30; i++) stand_in_render(transition, .1f + i * .03f);
+
+    // and the one after that is back to full resolution, on the direct path
+    stand_in_reset_recording();
+    stand_in_start(transition);
+    stand_in_render(transition, .5f);
+    CHECK(stand_in_find_draw("MeltScreenOver"));
+    CHECK(!stand_in_find_draw("Draw"));
+    stand_in_render(transition, 1.0f);
+
+    CHECK(stand_in_recording.errors == 0u && stand_in_recording.unlocked_calls == 0u);
+
+    stand_in_config.gpu_ms = .5f;
+    stand_in_config.lagged_frames = stand_in_config.skipped_frames = 0u;
+    stand_in_destroy(transition);
+}
+
+static void test_canvases(void)
+{
+    // scenes A and B at .5 and 2, and the one conversion libobs makes of them into the canvas: reinhard's
+    // x / (x + 1) onto SDR, 300 nits of SDR white over scRGB's 80 onto scRGB
+    static const struct {
+        enum gs_color_space canvas, scenes;
+        float a, b;
+    } canvases[] = {
+        {GS_CS_SRGB, GS_CS_SRGB, .5f, 2.0f},
+        {GS_CS_SRGB, GS_CS_709_EXTENDED, 1.0f / 3.0f, 2.0f / 3.0f},
+        {GS_CS_SRGB_16F, GS_CS_709_EXTENDED, 1.0f / 3.0f, 2.0f / 3.0f},
+        {GS_CS_709_EXTENDED, GS_CS_SRGB, .5f, 2.0f},
+        {GS_CS_709_EXTENDED, GS_CS_709_EXTENDED, .5f, 2.0f},
+        {GS_CS_709_SCRGB, GS_CS_SRGB, 1.875f, 7.5f},
+        {GS_CS_709_SCRGB, GS_CS_709_EXTENDED, 1.875f, 7.5f},
+    };
+
+    obs_data_t *settings = obs_data_create();
+    obs_source_t *transition = stand_in_create_transition("meltscr_transition", "canvas", settings, CX, CY);
+    obs_data_release(settings);
+
+    CHECK(transition != NULL);
+    if (!transition) return;
+
+    stand_in_config.scene_levels[0] = .5f;
+    stand_in_config.scene_levels[1] = 2.0f;
+
+    // the scenes arrive in the canvas space already, the melt pass composes them as they are and libobs never
+    // has to add a pass around it. scenes scaled to the transition take the regular path
+    for (size_t i = 0u; i < sizeof(canvases) / sizeof(canvases[0]); i++) {
+        for (int scaled = 0; scaled < 2; scaled++) {
+            stand_in_config.color_space = canvases[i].canvas;
+            stand_in_config.source_space = canvases[i].scenes;
+            stand_in_set_scene_size(transition, scaled ? CX / 2u : CX, scaled ? CY / 2u : CY);
+
+            stand_in_reset_recording();
+            stand_in_start(transition);
+            stand_in_render(transition, .5f);
+
+            const struct stand_in_draw *melt = stand_in_find_draw("MeltScreen");
+            CHECK(melt && !strcmp(melt->technique, scaled ? "MeltScreen" : "MeltScreenOver") && melt->target_cx == 0u);
+            CHECK(!stand_in_find_draw("Convert"));
+            CHECK(fabsf(stand_in_recording.output[0] - canvases[i].a) < 1e-4f && fabsf(stand_in_recording.output[1] - canvases[i].b) < 1e-4f);
+
+            stand_in_render(transition, 1.0f);
+            CHECK(fabsf(stand_in_recording.output[0] - canvases[i].b) < 1e-4f && fabsf(stand_in_recording.output[1] - canvases[i].b) < 1e-4f);
+        }
+    }
+
+    stand_in_config.color_space = stand_in_config.source_space = GS_CS_SRGB;
+    stand_in_set_scene_size(transition, CX, CY);
+
+    CHECK(stand_in_recording.errors == 0u && stand_in_recording.unlocked_calls == 0u);
+
+    stand_in_destroy(transition);
+}
+
+static void test_atlas(void)
+{
+    obs_data_t *settings = obs_data_create();
+    obs_source_t *first = stand_in_create_transition("meltscr_transition", "first", settings, CX, CY);
+    obs_data_release(settings);
+
+    settings = obs_data_create();
+    obs_source_t *second = stand_in_create_transition("meltscr_transition", "second", settings, CX, CY);
+    obs_data_release(settings);
+
+    CHECK(first && second);
+    if (!first || !second) {
+        if (first) stand_in_destroy(first);
+        if (second) stand_in_destroy(second);
+        return;
+    }
+
+    play(first, 2);
+
+    // a pattern written into an atlas that already exists only sends its own rows
+    stand_in_reset_recording();
+    stand_in_start(second);
+    stand_in_render(second, .5f);
+
+    const struct stand_in_draw *melt = stand_in_find_draw("MeltScreen");
+    CHECK(melt && melt->pattern == atlas.texture);
+    CHECK(stand_in_recording.texture_copies == 1u && stand_in_recording.upload_bytes == ATLAS_STAGING_ROWS * ATLAS_WIDTH);
+    CHECK(atlas.rows * ATLAS_WIDTH > stand_in_recording.upload_bytes);
+    stand_in_render(second, 1.0f);
+
+    // every row taken by a table somebody uses
+    struct meltscr_table *held[ATLAS_MAX_ROWS];
+    uint32_t held_count = 0u;
+
+    obs_enter_graphics();
+    for (bool full = false; !full && held_count < ATLAS_MAX_ROWS;) {
+        struct meltscr_table *table = bzalloc(sizeof(struct meltscr_table));
+        table->users = 1u;
+        table->_atlas_row = -1;
+
+        if (atlas_acquire_row(table)) held[held_count++] = table;
+        else {
+            bfree(table);
+            full = true;
+        }
+    }
+    obs_leave_graphics();
+
+    // so a new instance's pattern goes to a texture of its own, not a row somebody else's transition is using
+    settings = obs_data_create();
+    obs_source_t *third = stand_in_create_transition("meltscr_transition", "third", settings, CX, CY);
+    obs_data_release(settings);
+
+    stand_in_reset_recording();
+    stand_in_start(third);
+    stand_in_render(third, .5f);
+
+    melt = stand_in_find_draw("MeltScreen");
+    CHECK(stand_in_recording.warnings > 0u);
+    CHECK(melt && melt->pattern && melt->pattern != atlas.texture);
+    stand_in_render(third, 1.0f);
+
+    // and back to the atlas once a row frees up
+    obs_enter_graphics();
+    for (uint32_t i = 0u; i < held_count; i++) {
+        atlas_release_row(held[i]);
+        bfree(held[i]);
+    }
+    obs_leave_graphics();
+
+    stand_in_reset_recording();
+    stand_in_start(third);
+    stand_in_render(third, .5f);
+
+    melt = stand_in_find_draw("MeltScreen");
+    CHECK(melt && melt->pattern == atlas.texture);
+    stand_in_render(third, 1.0f);
+
+    CHECK(stand_in_recording.errors == 0u && stand_in_recording.unlocked_calls == 0u);
+
+    stand_in_destroy(first);
+    stand_in_destroy(second);
+    stand_in_destroy(third);
+}
+
+static void test_journal(void)
+{
+    obs_data_t *settings[2];
+    obs_source_t *transitions[2];
+    struct meltscr_table *owned[2];
+
+    // fixed random tables, each holding values of its own
+    for (int i = 0; i < 2; i++) {
+        settings[i] = obs_data_create();
+        obs_data_set_int(settings[i], "random_type", 1);
+        transitions[i] = stand_in_create_transition("meltscr_transition", "journaled", settings[i], CX, CY);
+        owned[i] = get_table_by_uuid((uint64_t)obs_data_get_int(settings[i], "uuid"));
+    }
+
+    CHECK(owned[0] && owned[1] && owned[0] != owned[1] && owned[0]->uuid != owned[1]->uuid);
+
+    if (owned[0] && owned[1] && owned[0] != owned[1]) {
+        // as read from a tables file written before uuids were unique, they get saved apart
+        owned[1]->uuid = owned[0]->uuid;
+        compact_tables_journal();
+        CHECK(owned[1]->uuid != owned[0]->uuid && get_table_by_uuid(owned[1]->uuid) == owned[1]);
+
+        // so replaying the journal reads each one's values back into it, not both into the first
+        int found[2] = {0, 0};
+
+        char *path = obs_module_config_path(JOURNAL_FILE);
+        FILE *f = fopen(path, "rb");
+        bfree(path);
+        CHECK(f != NULL);
+
+        if (f) {
+            struct meltscr_journal_record record;
+            uint8_t data[256];
+
+            fseek(f, TABLESFILE_HEADER_SIZE + 4, SEEK_SET);
+
+            while (fread(&record, sizeof(record), 1, f) == 1 && record.data_size <= sizeof(data) && fread(data, 1, record.data_size, f) == record.data_size) {
+                for (int i = 0; i < 2; i++) {
+                    if (record.type == JOURNAL_RECORD_TABLE && record.uuid == owned[i]->uuid && record.values_size == owned[i]->values_size &&
+                        !memcmp(data, owned[i]->_values, record.data_size))
+                        found[i]++;
+                }
+            }
+            fclose(f);
+        }
+
+        CHECK(found[0] == 1 && found[1] == 1);
+    }
+
+    // a record starting its walk past its own values is damaged, an empty pool starts at 0
+    struct meltscr_journal_record record = {0};
+    record.type = JOURNAL_RECORD_TABLE;
+    record.values_size = record.data_size = 16u;
+
+    record.position = 15u;
+    CHECK(journal_record_valid(&record));
+
+    record.position = 16u;
+    CHECK(!journal_record_valid(&record));
+
+    record.values_size = record.data_size = 0u;
+    record.position = 0u;
+    CHECK(journal_record_valid(&record));
+
+    CHECK(stand_in_recording.errors == 0u);
+
+    for (int i = 0; i < 2; i++) {
+        stand_in_destroy(transitions[i]);
+        obs_data_release(settings[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <data dir> <config dir>\n", argv[0]);
+        return 2;
+    }
+
+    stand_in_init(argv[2], argv[1]);
+
+    CHECK(obs_module_load());
+
+    test_defaults();
+    test_update();
+    test_governor();
+    test_canvases();
+    test_atlas();
+    test_journal();
+
+    obs_module_unload();
+
+    CHECK(stand_in_graphics_objects() == 0);
+
+    stand_in_shutdown();
+
+    // whatever the plugin allocated has been given back
+    CHECK(bnum_allocs() == 0);
+
+    if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// build step: precomputes every phase of the fixed presets into a C source linked into the plugin
+
+#include <stdio.h>
+#include <string.h>
+
+#include "meltscr-pattern.h"
+#include "meltscr-presets.h"
+
+struct bake_source {
+    const char *name;
+    uint16_t slices;
+    uint8_t steps;
+    float increment;
+    float factor;
+    const char *values_name;
+    const uint8_t *values;
+    uint16_t values_size;
+};
+
+// parameters must match what the plugin resolves them to, see the use_original branch of meltscr_update.
+// the rest are DooM mode at its default table size with the slice counts and steps most canvases end up using
+static const struct bake_source sources[] = {
+    {"doom", 160, 16, .0625f, .6f, "original_values", original_values, 256},
+    {"doom_80", 80, 16, .0625f, .6f, "original_values", original_values, 256},
+    {"doom_320", 320, 16, .0625f, .6f, "original_values", original_values, 256},
+    {"doom_640", 640, 16, .0625f, .6f, "original_values", original_values, 256},
+    {"doom_fine", 160, 64, .0625f, .6f, "original_values", original_values, 256},
+};
+
+#define SOURCE_COUNT (sizeof(sources) / sizeof(sources[0]))
+
+static int bake(FILE *f, const struct bake_source *src)
+{
+    // a phase is what goes in an atlas row, one offset per slice
+    const size_t stride = src->slices;
+
+    uint8_t *phases = calloc(src->values_size, stride);
+    uint8_t *batch = malloc((size_t)src->slices * PATTERN_LANES);
+
+    if (!phases || !batch) return 1;
+
+    uint32_t positions[PATTERN_LANES];
+
+    for (uint32_t first = 0u; first < src->values_size; first += PATTERN_LANES) {
+
+        // a partial last batch repeats positions, the extra lanes are discarded
+        for (int l = 0; l < PATTERN_LANES; l++) positions[l] = (first + l) % src->values_size;
+
+        meltscr_pattern_offsets_batch(batch, src->slices, src->values, src->values_size, positions, src->steps, src->increment, src->factor);
+
+        for (int l = 0; l < PATTERN_LANES && first + l < src->values_size; l++) {
+            meltscr_pattern_lane(&phases[(first + l) * stride], batch, src->slices, l);
+        }
+    }
+
+    fprintf(f, "static const uint8_t %s_phases[%zu] = {", src->name, src->values_size * stride);
+    for (size_t i = 0u; i < src->values_size * stride; i++) fprintf(f, "%s%u,", i % 32u ? "" : "\n    ", phases[i]);
+    fprintf(f, "\n};\n\n");
+
+    free(batch);
+    free(phases);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <output.c>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *f = fopen(argv[1], "w");
+    if (!f) {
+        fprintf(stderr, "unable to write '%s'\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(f, "// generated by bake-presets, do not edit\n\n#include \"meltscr-presets.h\"\n\n");
+
+    for (size_t i = 0u; i < SOURCE_COUNT; i++) {
+        if (bake(f, &sources[i])) {
+            fprintf(stderr, "out of memory baking '%s'\n", sources[i].name);
+            fclose(f);
+            return 1;
+        }
+    }
+
+    fprintf(f, "const struct meltscr_baked_preset baked_presets[] = {\n");
+    for (size_t i = 0u; i < SOURCE_COUNT; i++) {
+        const struct bake_source *src = &sources[i];
+        fprintf(f, "    {%u, %u, %.9gf, %.9gf, %u, %s, %s_phases},\n", src->slices, src->steps, src->increment, src->factor, src->values_size, src->values_name, src->name);
+    }
+    fprintf(f, "};\n\nconst size_t baked_preset_count = %zu;\n", SOURCE_COUNT);
+
+    return fclose(f) == 0 ? 0 : 1;
+}
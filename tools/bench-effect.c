@@ -0,0 +1,657 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// developer tool: renders the melt pass of the effect file on an EGL surfaceless OpenGL context (Mesa llvmpipe
+// when there's no GPU) and reports ms/frame over resolutions, slice counts, atlas sizes and directions.
+// the effect goes through the same HLSL to GLSL renames libobs' OpenGL backend does, and sampled frames are
+// compared against the CPU version of the melt pass, optionally saved for diffing.
+// the plugin itself runs on the stand-in libobs first, to check which passes it draws on SDR and HDR canvases
+
+#define GL_GLEXT_PROTOTYPES
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glcorearb.h>
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "meltscr-presets.h"
+#include "melt-reference.h"
+#include "stand-in.h"
+
+bool obs_module_load(void);
+void obs_module_unload(void);
+
+#define ATLAS_WIDTH 2048
+#define SAMPLED_FRAMES 3
+
+struct bench_direction {
+    const char *name;
+    float x, y;
+};
+
+// same order and vectors as the plugin's direction setting
+static const struct bench_direction directions[] = {{"up", .0f, -1.0f}, {"right", 1.0f, .0f}, {"down", .0f, 1.0f}, {"left", -1.0f, .0f}};
+
+static const uint32_t resolutions[][2] = {{1280u, 720u}, {1920u, 1080u}, {3840u, 2160u}};
+static const uint16_t slice_counts[] = {80u, 160u, 320u, 1600u};
+static const uint32_t atlas_rows[] = {1u, 256u};
+
+static const float sampled_t[SAMPLED_FRAMES] = {.25f, .5f, .75f};
+
+// DooM's pattern parameters, what the plugin defaults to
+#define BENCH_STEPS 16
+#define BENCH_INCREMENT .0625f
+#define BENCH_FACTOR .6f
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#pragma region -------------------------------------------------------------------------------------- EFFECT
+
+static char *read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *text = calloc((size_t)size + 1u, 1u);
+    if (text && fread(text, 1, (size_t)size, f) != (size_t)size) {
+        free(text);
+        text = NULL;
+    }
+
+    fclose(f);
+    return text;
+}
+
+static void append(char **out, size_t *length, const char *text, size_t count)
+{
+    *out = realloc(*out, *length + count + 1u);
+    memcpy(*out + *length, text, count);
+    *length += count;
+    (*out)[*length] = '\0';
+}
+
+// the pixel shader a technique runs, NULL if the effect has no such technique
+static char *find_pixel_shader(const char *effect, const char *technique)
+{
+    char header[128];
+    snprintf(header, sizeof(header), "technique %s\n", technique);
+
+    const char *found = strstr(effect, header);
+    if (!found) return NULL;
+
+    const char *shader = strstr(found, "pixel_shader");
+    if (!shader) return NULL;
+
+    shader = strchr(shader, '=');
+    while (shader && (*shader == '=' || *shader == ' ')) shader++;
+
+    const size_t length = shader ? strcspn(shader, "(") : 0u;
+    if (!length) return NULL;
+
+    char *name = calloc(length + 1u, 1u);
+    memcpy(name, shader, length);
+    return name;
+}
+
+// GLSL for one technique's pixel shader: everything before the techniques with libobs' renames applied,
+// sampler states dropped (the textures carry them) and a main() calling the technique's shader
+static char *translate_effect(const char *effect, const char *technique)
+{
+    char *pixel_shader = find_pixel_shader(effect, technique);
+    if (!pixel_shader) return NULL;
+
+    const char *end = strstr(effect, "\ntechnique ");
+    if (!end) end = effect + strlen(effect);
+
+    static const char prelude[] = "#version 330 core\n"
+                                  "#define float2 vec2\n#define float3 vec3\n#define float4 vec4\n#define float4x4 mat4\n"
+                                  "#define texture2d sampler2D\n#define lerp mix\n#define frac fract\n"
+                                  "#define saturate(x) clamp(x, 0.0, 1.0)\n#define mul(a, b) ((a) * (b))\n";
+
+    char *out = NULL;
+    size_t length = 0u;
+    append(&out, &length, prelude, sizeof(prelude) - 1u);
+
+    for (const char *c = effect; c < end;) {
+
+        if (!strncmp(c, "sampler_state", 13)) {
+            const char *close = strstr(c, "};");
+            c = close ? close + 2 : end;
+            continue;
+        }
+
+        // tex.Sample(sampler, uv) -> texture(tex, uv)
+        if (!strncmp(c, ".Sample(", 8)) {
+            size_t ident = 0u;
+            while (ident < length && (isalnum((unsigned char)out[length - ident - 1u]) || out[length - ident - 1u] == '_')) ident++;
+
+            char name[64];
+            snprintf(name, sizeof(name), "%.*s", (int)ident, out + length - ident);
+            length -= ident;
+
+            append(&out, &length, "texture(", 8u);
+            append(&out, &length, name, strlen(name));
+
+            c = strchr(c, ',');
+            if (!c) break;
+            continue;
+        }
+
+        // semantics, "pos : POSITION;" and "...) : TARGET"
+        if (!strncmp(c, " : ", 3) && isupper((unsigned char)c[3])) {
+            const char *semantic = c + 3;
+            while (isalnum((unsigned char)*semantic) || *semantic == '_') semantic++;
+
+            if (*semantic == ';' || *semantic == '\n' || *semantic == '\r') {
+                c = semantic;
+                continue;
+            }
+        }
+
+        append(&out, &length, c, 1u);
+        c++;
+    }
+
+    char main_text[256];
+    snprintf(main_text, sizeof(main_text),
+             "\nin vec2 uv_in;\nout vec4 melt_out;\n\nvoid main()\n{\n\tVertData v_in;\n\tv_in.pos = gl_FragCoord;\n\tv_in.uv = uv_in;\n\tmelt_out = %s(v_in);\n}\n",
+             pixel_shader);
+    append(&out, &length, main_text, strlen(main_text));
+
+    free(pixel_shader);
+    return out;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- OPENGL
+
+struct bench_program {
+    GLuint program;
+    GLint tex_a, tex_b, tex_c, tex_d;
+    GLint factor, sizes, atlas, dir, dir_mask, progress, fade_color;
+};
+
+static GLuint compile_shader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+    if (!compiled) {
+        char log[4096];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "shader compilation failed:\n%s\n", log);
+        glDeleteShader(shader);
+        return 0u;
+    }
+    return shader;
+}
+
+// the sprite libobs draws, uv (0,0) at the first row of every texture
+static const char vertex_source[] = "#version 330 core\n"
+                                    "layout(location = 0) in vec2 pos;\nout vec2 uv_in;\n"
+                                    "void main()\n{\n\tuv_in = pos * 0.5 + 0.5;\n\tgl_Position = vec4(pos, 0.0, 1.0);\n}\n";
+
+static bool create_program(struct bench_program *p, const char *effect, const char *technique)
+{
+    char *source = translate_effect(effect, technique);
+    if (!source) {
+        fprintf(stderr, "the effect has no technique '%s'\n", technique);
+        return false;
+    }
+
+    GLuint vs = compile_shader(GL_VERTEX_SHADER, vertex_source);
+    GLuint fs = compile_shader(GL_FRAGMENT_SHADER, source);
+    free(source);
+
+    if (!vs || !fs) return false;
+
+    p->program = glCreateProgram();
+    glAttachShader(p->program, vs);
+    glAttachShader(p->program, fs);
+    glLinkProgram(p->program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(p->program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        fprintf(stderr, "'%s' failed to link\n", technique);
+        return false;
+    }
+
+    p->tex_a = glGetUniformLocation(p->program, "tex_a");
+    p->tex_b = glGetUniformLocation(p->program, "tex_b");
+    p->tex_c = glGetUniformLocation(p->program, "tex_c");
+    p->tex_d = glGetUniformLocation(p->program, "tex_d");
+    p->factor = glGetUniformLocation(p->program, "factor");
+    p->sizes = glGetUniformLocation(p->program, "sizes");
+    p->atlas = glGetUniformLocation(p->program, "atlas");
+    p->dir = glGetUniformLocation(p->program, "dir");
+    p->dir_mask = glGetUniformLocation(p->program, "dir_mask");
+    p->progress = glGetUniformLocation(p->program, "progress");
+    p->fade_color = glGetUniformLocation(p->program, "fade_color");
+    return true;
+}
+
+static GLuint create_texture(GLenum internal_format, uint32_t cx, uint32_t cy, GLenum format, const void *data, GLint filter)
+{
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, (GLint)internal_format, (GLsizei)cx, (GLsizei)cy, 0, format, GL_UNSIGNED_BYTE, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return tex;
+}
+
+static bool create_context(void)
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    EGLDisplay display = get_platform_display ? get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL) : EGL_NO_DISPLAY;
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        fprintf(stderr, "no surfaceless EGL display\n");
+        return false;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+
+    // libobs' OpenGL backend asks for 3.3 core as well
+    const EGLint attribs[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3, EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                              EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+
+    EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attribs);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        fprintf(stderr, "couldn't create an OpenGL 3.3 core context\n");
+        return false;
+    }
+
+    printf("%s, %s\n", (const char *)glGetString(GL_RENDERER), (const char *)glGetString(GL_VERSION));
+    return true;
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- BENCHMARK
+
+// stand-in scenes, every pixel of A differs from the one under it in B
+static void fill_scenes(uint32_t *a, uint32_t *b, uint32_t cx, uint32_t cy)
+{
+    for (uint32_t y = 0u; y < cy; y++) {
+        for (uint32_t x = 0u; x < cx; x++) {
+            const uint32_t r = x * 255u / cx, g = y * 255u / cy;
+            a[y * cx + x] = 0xFF000000u | 0x400000u | g << 8 | r;
+            b[y * cx + x] = 0xFF000000u | (((x >> 4) ^ (y >> 4)) & 1u ? 0xC0C0C0u : 0x202020u);
+        }
+    }
+}
+
+static void save_ppm(const char *path, const uint32_t *pixels, uint32_t cx, uint32_t cy)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "couldn't write '%s'\n", path);
+        return;
+    }
+
+    fprintf(f, "P6\n%u %u\n255\n", cx, cy);
+
+    for (size_t i = 0u; i < (size_t)cx * cy; i++) {
+        const uint8_t rgb[3] = {(uint8_t)pixels[i], (uint8_t)(pixels[i] >> 8), (uint8_t)(pixels[i] >> 16)};
+        fwrite(rgb, 1, 3, f);
+    }
+
+    fclose(f);
+}
+
+struct bench_case {
+    uint32_t cx, cy;
+    uint16_t slices;
+    uint32_t rows;
+    const struct bench_direction *dir;
+    bool hdr; // half float scenes and target, what libobs renders in for HDR canvases
+    bool over; // premultiplied over what's already there, the direct path
+    bool compare; // against the CPU version, which only has the plain melt
+};
+
+struct bench_result {
+    double avg_ms;
+    double max_ms;
+    double mismatch; // fraction of the sampled frames' pixels that differ from the CPU version
+};
+
+static void run_case(const struct bench_program *p, const struct bench_case *bc, uint32_t frames, const char *save_dir, struct bench_result *result)
+{
+    const uint32_t cx = bc->cx, cy = bc->cy;
+    const size_t pixels = (size_t)cx * cy;
+
+    uint32_t *a = malloc(pixels * sizeof(uint32_t)), *b = malloc(pixels * sizeof(uint32_t));
+    uint32_t *gpu = malloc(pixels * sizeof(uint32_t)), *cpu = malloc(pixels * sizeof(uint32_t));
+    uint8_t *atlas = calloc((size_t)ATLAS_WIDTH * bc->rows, 1u);
+
+    fill_scenes(a, b, cx, cy);
+
+    // the pattern sits in the middle row, like any table the atlas holds
+    const uint32_t row = bc->rows / 2u;
+    meltscr_pattern_offsets(&atlas[(size_t)row * ATLAS_WIDTH], bc->slices, original_values, 256u, 0u, BENCH_STEPS, BENCH_INCREMENT, BENCH_FACTOR);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // SDR scenes and target are sRGB like the plugin samples and renders them, the atlas is raw bytes
+    const GLenum format = bc->hdr ? GL_RGBA16F : GL_SRGB8_ALPHA8;
+
+    GLuint tex_a = create_texture(format, cx, cy, GL_RGBA, a, GL_NEAREST);
+    GLuint tex_b = create_texture(format, cx, cy, GL_RGBA, b, GL_NEAREST);
+    GLuint tex_c = create_texture(GL_R8, ATLAS_WIDTH, bc->rows, GL_RED, atlas, GL_NEAREST);
+    GLuint tex_d = create_texture(GL_R8, 1u, 1u, GL_RED, atlas, GL_LINEAR);
+    GLuint target = create_texture(format, cx, cy, GL_RGBA, NULL, GL_NEAREST);
+
+    GLuint fbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+    glViewport(0, 0, (GLsizei)cx, (GLsizei)cy);
+    glEnable(GL_FRAMEBUFFER_SRGB);
+
+    if (bc->over) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    glUseProgram(p->program);
+
+    const GLuint textures[4] = {tex_a, tex_b, tex_c, tex_d};
+    const GLint units[4] = {p->tex_a, p->tex_b, p->tex_c, p->tex_d};
+    for (int i = 0; i < 4; i++) {
+        glActiveTexture(GL_TEXTURE0 + (GLenum)i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glUniform1i(units[i], i);
+    }
+
+    // uniforms as meltscr_video_callback sets them
+    const float dx = bc->dir->x, dy = bc->dir->y;
+    glUniform2f(p->factor, BENCH_FACTOR, 1.0f / BENCH_FACTOR);
+    glUniform2f(p->sizes, (float)bc->slices, 1.0f / bc->slices);
+    glUniform2f(p->atlas, 1.0f / ATLAS_WIDTH, (row + .5f) / bc->rows);
+    glUniform2f(p->dir, dx, dy);
+    glUniform3f(p->dir_mask, fabsf(dx), fabsf(dy), dx + (dy - dx) * fabsf(dy));
+    glUniform4f(p->fade_color, .0f, .0f, .0f, .25f);
+
+    uint64_t total_ns = 0u, max_ns = 0u;
+    size_t differing = 0u, compared = 0u;
+
+    // one untimed frame so shader compilation and uploads aren't counted
+    for (uint32_t i = 0u; i <= frames; i++) {
+        const float t = i ? (i - .5f) / frames : .5f;
+
+        glUniform2f(p->progress, t, t * (1.0f + BENCH_FACTOR));
+
+        const uint64_t start_ns = get_time_ns();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glFinish();
+        const uint64_t elapsed = get_time_ns() - start_ns;
+
+        if (i) {
+            total_ns += elapsed;
+            if (elapsed > max_ns) max_ns = elapsed;
+        }
+    }
+
+    for (int s = 0; s < (bc->compare ? SAMPLED_FRAMES : 0); s++) {
+        const float t = sampled_t[s];
+
+        glUniform2f(p->progress, t, t * (1.0f + BENCH_FACTOR));
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glReadPixels(0, 0, (GLsizei)cx, (GLsizei)cy, GL_RGBA, GL_UNSIGNED_BYTE, gpu);
+
+        melt_reference_frame(cpu, a, b, cx, cy, dx, dy, BENCH_FACTOR, t, &atlas[(size_t)row * ATLAS_WIDTH], ATLAS_WIDTH, bc->slices);
+
+        for (size_t i = 0u; i < pixels; i++) differing += gpu[i] != cpu[i];
+        compared += pixels;
+
+        if (save_dir) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/melt-%ux%u-%u-%u-%s-%02d-gpu.ppm", save_dir, cx, cy, bc->slices, bc->rows, bc->dir->name, (int)(t * 100.0f));
+            save_ppm(path, gpu, cx, cy);
+            snprintf(path, sizeof(path), "%s/melt-%ux%u-%u-%u-%s-%02d-cpu.ppm", save_dir, cx, cy, bc->slices, bc->rows, bc->dir->name, (int)(t * 100.0f));
+            save_ppm(path, cpu, cx, cy);
+        }
+    }
+
+    result->avg_ms = total_ns / 1000000.0 / frames;
+    result->max_ms = max_ns / 1000000.0;
+    result->mismatch = compared ? (double)differing / compared : .0;
+
+    glDisable(GL_BLEND);
+
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(4, textures);
+    glDeleteTextures(1, &target);
+
+    free(a);
+    free(b);
+    free(gpu);
+    free(cpu);
+    free(atlas);
+}
+
+#pragma endregion
+
+#pragma region -------------------------------------------------------------------------------------- CANVASES
+
+struct bench_canvas {
+    const char *name;
+    enum gs_color_space canvas;
+    enum gs_color_space scenes;
+};
+
+static const struct bench_canvas canvases[] = {
+    {"SDR", GS_CS_SRGB, GS_CS_SRGB},
+    {"SDR, HDR scenes", GS_CS_SRGB, GS_CS_709_EXTENDED},
+    {"HDR", GS_CS_709_EXTENDED, GS_CS_709_EXTENDED},
+    {"scRGB", GS_CS_709_SCRGB, GS_CS_709_EXTENDED},
+};
+
+// the plugin renders a frame on each canvas through the stand-in libobs, which adds a conversion pass around
+// any source whose colour space isn't the canvas'. none may run, and the melt pass is the only draw to the output.
+// the pass it drew is then timed in the format the canvas renders in
+static int run_canvases(const char *effect, const char *data_dir, uint32_t frames)
+{
+    char config_dir[512];
+    const char *tmp = getenv("TMPDIR");
+    snprintf(config_dir, sizeof(config_dir), "%s/meltscr-bench", tmp && *tmp ? tmp : "/tmp");
+
+    stand_in_init(config_dir, data_dir);
+
+    if (!obs_module_load()) return 1;
+
+    printf("%-16s %-8s %-28s %7s %12s %10s\n", "canvas", "path", "melt pass", "passes", "conversions", "avg ms");
+
+    int failed = 0;
+
+    for (size_t c = 0u; c < sizeof(canvases) / sizeof(canvases[0]); c++) {
+        for (int regular = 0; regular < 2; regular++) {
+
+            stand_in_config.color_space = canvases[c].canvas;
+            stand_in_config.source_space = canvases[c].scenes;
+
+            // a fade touches B as well, so it takes the regular path
+            obs_data_t *settings = obs_data_create();
+            if (regular) obs_data_set_int(settings, "fade_amount", 50);
+
+            obs_source_t *transition = stand_in_create_transition("meltscr_transition", "bench", settings, 1920u, 1080u);
+            obs_data_release(settings);
+
+            if (!transition) return 1;
+
+            stand_in_start(transition);
+            stand_in_reset_recording();
+            stand_in_render(transition, .5f);
+
+            const struct stand_in_recording recorded = stand_in_recording;
+
+            stand_in_render(transition, 1.0f);
+            stand_in_destroy(transition);
+
+            uint32_t passes = 0u, conversions = 0u;
+            const struct stand_in_draw *melt = NULL;
+
+            for (uint32_t i = 0u; i < recorded.draw_count; i++) {
+                const struct stand_in_draw *draw = &recorded.draws[i];
+
+                if (!strcmp(draw->technique, "Convert")) conversions++;
+                else if (!strncmp(draw->technique, "MeltScreen", 10) && !draw->target_cx) {
+                    passes++;
+                    melt = draw;
+                }
+            }
+
+            double avg_ms = .0;
+
+            if (melt) {
+                struct bench_program program;
+
+                if (!create_program(&program, effect, melt->technique)) return 1;
+
+                const struct bench_case bc = {1920u, 1080u, 160u, 1u, &directions[2], canvases[c].canvas != GS_CS_SRGB,
+                                              melt->blending && melt->src == GS_BLEND_ONE, false};
+                struct bench_result result;
+
+                run_case(&program, &bc, frames, NULL, &result);
+                glDeleteProgram(program.program);
+
+                avg_ms = result.avg_ms;
+            }
+
+            printf("%-16s %-8s %-28s %7u %12u %10.3f\n", canvases[c].name, regular ? "regular" : "direct", melt ? melt->technique : "-", passes,
+                   conversions, avg_ms);
+
+            if (passes != 1u || conversions || recorded.errors) failed = 1;
+        }
+    }
+
+    obs_module_unload();
+    stand_in_shutdown();
+
+    if (failed) fprintf(stderr, "a canvas needed a conversion pass or didn't get exactly one melt pass\n");
+    return failed;
+}
+
+#pragma endregion
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <spz-meltscr-transition.effect> [frames] [-o <dir>]\n"
+                        "  -o saves the sampled 720p frames and their CPU versions as PPM files\n",
+                argv[0]);
+        return 1;
+    }
+
+    uint32_t frames = 16u;
+    const char *save_dir = NULL;
+
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc) save_dir = argv[++i];
+        else frames = (uint32_t)imax(atoi(argv[i]), 1);
+    }
+
+    char *effect = read_file(argv[1]);
+    if (!effect) {
+        fprintf(stderr, "couldn't read '%s'\n", argv[1]);
+        return 1;
+    }
+
+    if (!create_context()) {
+        free(effect);
+        return 1;
+    }
+
+    struct bench_program program;
+
+    if (!create_program(&program, effect, "MeltScreen")) {
+        free(effect);
+        return 1;
+    }
+
+    // the sprite, a single triangle covering the target
+    const float vertices[] = {-1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f};
+
+    GLuint vao, vbo;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+
+    // next to the effect, where obs_module_file looks
+    char data_dir[512];
+    snprintf(data_dir, sizeof(data_dir), "%s", argv[1]);
+    char *slash = strrchr(data_dir, '/');
+    if (slash) *slash = '\0';
+    else snprintf(data_dir, sizeof(data_dir), ".");
+
+    printf("passes drawn per canvas at 1080p, %u frame(s) each\n", frames);
+    int worst = run_canvases(effect, data_dir, frames);
+    free(effect);
+
+    printf("\nMeltScreen, %u frame(s) across the progress range per case\n", frames);
+    printf("%-10s %6s %6s %-6s %10s %10s %10s\n", "size", "slices", "rows", "dir", "avg ms", "max ms", "vs cpu");
+
+
+    for (size_t r = 0u; r < sizeof(resolutions) / sizeof(resolutions[0]); r++) {
+        for (size_t s = 0u; s < sizeof(slice_counts) / sizeof(slice_counts[0]); s++) {
+            for (size_t a = 0u; a < sizeof(atlas_rows) / sizeof(atlas_rows[0]); a++) {
+                for (size_t d = 0u; d < sizeof(directions) / sizeof(directions[0]); d++) {
+
+                    const struct bench_case bc = {resolutions[r][0], resolutions[r][1], slice_counts[s], atlas_rows[a], &directions[d], false, false, true};
+                    struct bench_result result;
+
+                    run_case(&program, &bc, frames, r == 0u ? save_dir : NULL, &result);
+
+                    char size[16];
+                    snprintf(size, sizeof(size), "%ux%u", bc.cx, bc.cy);
+                    printf("%-10s %6u %6u %-6s %10.3f %10.3f %9.3f%%\n", size, bc.slices, bc.rows, bc.dir->name, result.avg_ms, result.max_ms,
+                           result.mismatch * 100.0);
+
+                    // pixels right on a slice or texel edge may land on either side between the two, 720 rows over 160 slices
+                    // put every other slice edge on a pixel centre. anything past that is a real difference
+                    if (result.mismatch > .02) worst = 1;
+                }
+            }
+        }
+    }
+
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(program.program);
+
+    if (worst) fprintf(stderr, "some cases differ from the CPU version by more than 2%% of their pixels\n");
+    return worst;
+}
@@ -0,0 +1,47 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// CPU version of the melt pass shared by the developer tools, plain C like the pattern core
+
+#pragma once
+
+#include "meltscr-pattern.h"
+
+// same maths as Melt() in the effect, without the colour operations and motion curves.
+// 'offsets' is one atlas row, 'slices' of them are read
+static inline void melt_reference_frame(uint32_t *out, const uint32_t *a, const uint32_t *b, uint32_t cx, uint32_t cy, float dx, float dy, float factor, float t,
+                                        const uint8_t *offsets, uint32_t offsets_size, uint16_t slices)
+{
+    const float mx = fabsf(dx), my = fabsf(dy), mz = dx + (dy - dx) * my;
+    const float progress = t * (1.0f + factor);
+    const float reach = progress < .0f ? .0f : progress > 1.0f ? 1.0f : progress;
+    const int last = imax((int)offsets_size - 1, 0);
+
+    for (uint32_t y = 0u; y < cy; y++) {
+        const float v = (y + .5f) / cy;
+
+        for (uint32_t x = 0u; x < cx; x++) {
+            const float u = (x + .5f) / cx;
+
+            float mu = u - dx * progress, mv = v - dy * progress;
+
+            float along = mu + (mv - mu) * mx;
+            along = along < .0f ? .0f : along > 1.0f ? 1.0f : along;
+
+            const int slice = clamp((int)(slices * along), 0, last);
+            const float offset = fminf(offsets[slice] / 255.0f, reach) * mz;
+
+            mu += mx * offset;
+            mv += my * offset;
+
+            if (mu < .0f || mv < .0f || mu > 1.0f || mv > 1.0f) out[y * cx + x] = b[y * cx + x];
+            else {
+                const uint32_t sx = (uint32_t)clamp((int)(mu * cx), 0, (int)cx - 1);
+                const uint32_t sy = (uint32_t)clamp((int)(mv * cy), 0, (int)cy - 1);
+                out[y * cx + x] = a[sy * cx + sx];
+            }
+        }
+    }
+}
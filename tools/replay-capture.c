@@ -0,0 +1,225 @@
+/*
+Sopze's meltscr transition
+Copyright (C) 2025 Sergio 'sopze' del Pino Arroyo -- sergiodepa92@gmail.com
+*/
+
+// developer tool: replays a capture log (MELTDEMO.LMP) through a CPU version of the melt pass and compares timings
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "meltscr-capture.h"
+#include "melt-reference.h"
+
+struct replay_transition {
+    struct meltscr_capture_transition record;
+    uint8_t *offsets;
+    struct meltscr_capture_frame *frames;
+    uint32_t frame_count;
+    uint32_t frame_capacity;
+};
+
+struct replay_stats {
+    uint32_t count;
+    uint64_t total;
+    uint64_t max;
+};
+
+static struct replay_transition *transitions = NULL;
+static uint32_t transition_count = 0u;
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void stats_add(struct replay_stats *s, uint64_t value)
+{
+    s->count++;
+    s->total += value;
+    if (value > s->max) s->max = value;
+}
+
+static double stats_avg(const struct replay_stats *s)
+{
+    return s->count ? (double)s->total / s->count : .0;
+}
+
+// the most recent transition of an instance owns the frames that come after it
+static struct replay_transition *find_open_transition(uint32_t instance)
+{
+    for (uint32_t i = transition_count; i > 0u; i--) {
+        if (transitions[i - 1u].record.instance == instance) return &transitions[i - 1u];
+    }
+    return NULL;
+}
+
+static int read_capture(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "couldn't open '%s'\n", path);
+        return 1;
+    }
+
+    struct meltscr_capture_header header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != CAPTURE_MAGIC || header.version != CAPTURE_VERSION) {
+        fprintf(stderr, "'%s' isn't a capture log this tool can read\n", path);
+        fclose(f);
+        return 1;
+    }
+
+    uint8_t type;
+    uint32_t orphans = 0u;
+
+    // records are only ever appended, a truncated one can only be the last
+    while (fread(&type, 1, 1, f) == 1) {
+
+        if (type == CAPTURE_RECORD_TRANSITION) {
+            struct replay_transition tr = {0};
+            tr.record.type = type;
+
+            if (fread((uint8_t *)&tr.record + 1, sizeof(tr.record) - 1, 1, f) != 1) break;
+
+            tr.offsets = malloc(tr.record.offsets_size ? tr.record.offsets_size : 1u);
+            if (!tr.offsets || fread(tr.offsets, 1, tr.record.offsets_size, f) != tr.record.offsets_size) {
+                free(tr.offsets);
+                break;
+            }
+
+            struct replay_transition *grown = realloc(transitions, sizeof(*transitions) * (transition_count + 1u));
+            if (!grown) return 1;
+
+            transitions = grown;
+            transitions[transition_count++] = tr;
+        }
+        else if (type == CAPTURE_RECORD_FRAME) {
+            struct meltscr_capture_frame frame;
+            frame.type = type;
+
+            if (fread((uint8_t *)&frame + 1, sizeof(frame) - 1, 1, f) != 1) break;
+
+            struct replay_transition *tr = find_open_transition(frame.instance);
+            if (!tr) {
+                orphans++;
+                continue;
+            }
+
+            if (tr->frame_count == tr->frame_capacity) {
+                tr->frame_capacity = tr->frame_capacity ? tr->frame_capacity * 2u : 64u;
+                struct meltscr_capture_frame *grown = realloc(tr->frames, sizeof(frame) * tr->frame_capacity);
+                if (!grown) return 1;
+                tr->frames = grown;
+            }
+
+            tr->frames[tr->frame_count++] = frame;
+        }
+        else {
+            fprintf(stderr, "unknown record type %u, stopping there\n", type);
+            break;
+        }
+    }
+
+    if (orphans) fprintf(stderr, "%u frame(s) without a transition were skipped\n", orphans);
+
+    fclose(f);
+    return 0;
+}
+
+static int replay(uint32_t repeats, int verbose)
+{
+    uint32_t *a = NULL, *b = NULL, *out = NULL;
+    size_t pixels = 0u;
+
+    for (uint32_t i = 0u; i < transition_count; i++) {
+        const struct replay_transition *tr = &transitions[i];
+        const struct meltscr_capture_transition *r = &tr->record;
+
+        printf("transition %u: instance %u, %s table %" PRIu64 " @%u, %u slices, %u steps, factor %.3f, increment %.4f, dir (%.0f,%.0f), motion %u, start %.1fus\n",
+               i, r->instance, r->table_type == 0 ? "DooM" : r->table_type == 1 ? "fixed" : "dynamic", r->uuid, r->position, r->slices,
+               r->steps, r->factor, r->increment, r->dir[0], r->dir[1], r->motion, r->start_ns / 1000.0);
+
+        struct replay_stats recorded_cpu = {0}, recorded_gpu = {0}, replayed = {0};
+
+        for (uint32_t j = 0u; j < tr->frame_count; j++) {
+            const struct meltscr_capture_frame *frame = &tr->frames[j];
+
+            if (!frame->cx || !frame->cy) continue;
+
+            if ((size_t)frame->cx * frame->cy > pixels) {
+                pixels = (size_t)frame->cx * frame->cy;
+                free(a);
+                free(b);
+                free(out);
+                a = malloc(pixels * sizeof(uint32_t));
+                b = malloc(pixels * sizeof(uint32_t));
+                out = malloc(pixels * sizeof(uint32_t));
+                if (!a || !b || !out) return 1;
+            }
+
+            // stand-in scenes, the pattern of the melt is all that affects the timing
+            for (size_t p = 0u; p < (size_t)frame->cx * frame->cy; p++) {
+                a[p] = (uint32_t)p * 2654435761u;
+                b[p] = ~a[p];
+            }
+
+            uint64_t best = UINT64_MAX;
+            for (uint32_t k = 0u; k < repeats; k++) {
+                const uint64_t start_ns = get_time_ns();
+                melt_reference_frame(out, a, b, frame->cx, frame->cy, r->dir[0], r->dir[1], r->factor, frame->t, tr->offsets, r->offsets_size, frame->slices);
+                const uint64_t elapsed = get_time_ns() - start_ns;
+                if (elapsed < best) best = elapsed;
+            }
+
+            stats_add(&recorded_cpu, frame->cpu_ns);
+            if (frame->gpu_us) stats_add(&recorded_gpu, frame->gpu_us);
+            stats_add(&replayed, best);
+
+            if (verbose) {
+                printf("  t %.4f %ux%u, %u slices, technique %u: recorded cpu %.1fus gpu %uus, replayed %.1fus\n", frame->t, frame->cx, frame->cy,
+                       frame->slices, frame->technique, frame->cpu_ns / 1000.0, frame->gpu_us, best / 1000.0);
+            }
+        }
+
+        printf("  %u frame(s), recorded cpu avg %.1fus max %.1fus, gpu avg %.1fus max %" PRIu64 "us, replayed avg %.1fus max %.1fus\n",
+               recorded_cpu.count, stats_avg(&recorded_cpu) / 1000.0, recorded_cpu.max / 1000.0, stats_avg(&recorded_gpu), recorded_gpu.max,
+               stats_avg(&replayed) / 1000.0, replayed.max / 1000.0);
+    }
+
+    free(a);
+    free(b);
+    free(out);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <MELTDEMO.LMP> [repeats] [-v]\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t repeats = 1u;
+    int verbose = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-v")) verbose = 1;
+        else repeats = (uint32_t)imax(atoi(argv[i]), 1);
+    }
+
+    if (read_capture(argv[1])) return 1;
+
+    const int result = replay(repeats, verbose);
+
+    for (uint32_t i = 0u; i < transition_count; i++) {
+        free(transitions[i].offsets);
+        free(transitions[i].frames);
+    }
+    free(transitions);
+
+    return result;
+}